@@ -0,0 +1,292 @@
+/* Atomic versions of Mod_Type and Range_Type, for counters and indices shared between threads
+ * Every read gives a value in range, and a failing operation does not change the value
+ * Lock free whenever std::atomic of the underlying type is
+ *
+ * License:
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include <atomic>
+#include <type_traits>
+#include "mod_type.h"
+#include "range_type.h"
+
+#ifndef ATOMIC_TYPE_H_INCLUDED
+#define ATOMIC_TYPE_H_INCLUDED
+
+namespace atomic_type_order {
+    // strongest order allowed for the failing side of a compare exchange done with order
+    constexpr std::memory_order failure_order (std::memory_order order) {
+        return order == std::memory_order_acq_rel ? std::memory_order_acquire
+             : order == std::memory_order_release ? std::memory_order_relaxed
+             :                                      order;
+    }
+}
+
+// Mod_Type<T, UB> that can be shared between threads
+// When UB is a power of two, the stored count runs freely and is reduced on read,
+// so fetch_add and fetch_sub are single atomic instructions
+// Otherwise they are compare exchange loops, which keep the stored value reduced
+template <typename T, long long int UB>
+class Atomic_Mod_Type {
+public:
+    using value_type = Mod_Type<T, UB>;
+
+    Atomic_Mod_Type () : raw {0} {}
+
+    Atomic_Mod_Type (const value_type& a) : raw {unsigned_T(a.val)} {}
+
+    Atomic_Mod_Type (const Atomic_Mod_Type&) = delete;
+
+    Atomic_Mod_Type& operator= (const Atomic_Mod_Type&) = delete;
+
+    bool is_lock_free () const {
+        return raw.is_lock_free();
+    }
+
+    value_type load (std::memory_order order = std::memory_order_seq_cst) const {
+        return value_of(raw.load(order));
+    }
+
+    void store (const value_type& a, std::memory_order order = std::memory_order_seq_cst) {
+        raw.store(unsigned_T(a.val), order);
+    }
+
+    value_type exchange (const value_type& a, std::memory_order order = std::memory_order_seq_cst) {
+        return value_of(raw.exchange(unsigned_T(a.val), order));
+    }
+
+    // on failure, expected is set to the current value
+    bool compare_exchange_weak (value_type& expected, const value_type& desired,
+                                std::memory_order success, std::memory_order failure) {
+        return compare_exchange(expected, desired, success, failure, false, free_running());
+    }
+
+    bool compare_exchange_weak (value_type& expected, const value_type& desired,
+                                std::memory_order order = std::memory_order_seq_cst) {
+        return compare_exchange_weak(expected, desired, order, atomic_type_order::failure_order(order));
+    }
+
+    bool compare_exchange_strong (value_type& expected, const value_type& desired,
+                                  std::memory_order success, std::memory_order failure) {
+        return compare_exchange(expected, desired, success, failure, true, free_running());
+    }
+
+    bool compare_exchange_strong (value_type& expected, const value_type& desired,
+                                  std::memory_order order = std::memory_order_seq_cst) {
+        return compare_exchange_strong(expected, desired, order, atomic_type_order::failure_order(order));
+    }
+
+    // both give the value held before the operation
+    value_type fetch_add (const value_type& a, std::memory_order order = std::memory_order_seq_cst) {
+        return fetch_add(unsigned_T(a.val), order, free_running());
+    }
+
+    value_type fetch_sub (const value_type& a, std::memory_order order = std::memory_order_seq_cst) {
+        return fetch_sub(unsigned_T(a.val), order, free_running());
+    }
+
+private:
+    using unsigned_T = typename std::make_unsigned<T>::type;
+
+    // UB divides the modulus of unsigned_T, so wrapping around unsigned_T keeps the value mod UB
+    using free_running = std::integral_constant<bool, (UB & (UB - 1)) == 0>;
+
+    std::atomic<unsigned_T> raw;
+
+    static value_type value_of (unsigned_T a) {
+        return value_type::reduced(T(a & mask(free_running())));
+    }
+
+    static constexpr unsigned_T mask (std::true_type) {
+        return unsigned_T(UB - 1);
+    }
+
+    static constexpr unsigned_T mask (std::false_type) {
+        return unsigned_T(~unsigned_T(0));
+    }
+
+    value_type fetch_add (unsigned_T a, std::memory_order order, std::true_type) {
+        return value_of(raw.fetch_add(a, order));
+    }
+
+    value_type fetch_sub (unsigned_T a, std::memory_order order, std::true_type) {
+        return value_of(raw.fetch_sub(a, order));
+    }
+
+    value_type fetch_add (unsigned_T a, std::memory_order order, std::false_type) {
+        unsigned_T old = raw.load(std::memory_order_relaxed);
+
+        while (!raw.compare_exchange_weak(old, unsigned_T(value_type::mod_add_reduced(T(old), T(a))),
+                                          order, std::memory_order_relaxed)) {}
+
+        return value_of(old);
+    }
+
+    value_type fetch_sub (unsigned_T a, std::memory_order order, std::false_type) {
+        unsigned_T old = raw.load(std::memory_order_relaxed);
+
+        while (!raw.compare_exchange_weak(old, unsigned_T(value_type::mod_sub_reduced(T(old), T(a))),
+                                          order, std::memory_order_relaxed)) {}
+
+        return value_of(old);
+    }
+
+    // stored value may carry multiples of UB, so it is compared after reduction
+    bool compare_exchange (value_type& expected, const value_type& desired,
+                           std::memory_order success, std::memory_order failure, bool strong, std::true_type) {
+        unsigned_T current = raw.load(failure);
+
+        while (value_of(current) == expected) {
+            if (raw.compare_exchange_weak(current, unsigned_T(desired.val), success, failure)) {
+                return true;
+            }
+
+            if (!strong) {
+                break;
+            }
+        }
+
+        expected = value_of(current);
+        return false;
+    }
+
+    bool compare_exchange (value_type& expected, const value_type& desired,
+                           std::memory_order success, std::memory_order failure, bool strong, std::false_type) {
+        unsigned_T current = unsigned_T(expected.val);
+        bool done = strong ? raw.compare_exchange_strong(current, unsigned_T(desired.val), success, failure)
+                           : raw.compare_exchange_weak(current, unsigned_T(desired.val), success, failure);
+
+        expected = value_of(current);
+        return done;
+    }
+};
+
+// Range_Type<T, F, L, Policy> that can be shared between threads
+// fetch_add and fetch_sub are compare exchange loops, the new value is checked before it is stored
+// A violation is handled by Policy as for Range_Type, before anything is stored
+//     Throw_On_Violation   : throws, the value is left unchanged
+//     Status_On_Violation  : returns the status, the value is left unchanged
+//     other policies       : the replacement value given by the policy is stored
+template <typename T, long long int F, long long int L, typename Policy = Throw_On_Violation>
+class Atomic_Range_Type {
+public:
+    using value_type  = Range_Type<T, F, L, Policy>;
+    using result_type = typename value_type::result_type;
+
+    Atomic_Range_Type () : val {T(F)} {}
+
+    Atomic_Range_Type (const value_type& a) : val {a.value()} {}
+
+    Atomic_Range_Type (const Atomic_Range_Type&) = delete;
+
+    Atomic_Range_Type& operator= (const Atomic_Range_Type&) = delete;
+
+    bool is_lock_free () const {
+        return val.is_lock_free();
+    }
+
+    value_type load (std::memory_order order = std::memory_order_seq_cst) const {
+        return value_type(val.load(order), typename value_type::unchecked_tag());
+    }
+
+    void store (const value_type& a, std::memory_order order = std::memory_order_seq_cst) {
+        val.store(a.value(), order);
+    }
+
+    value_type exchange (const value_type& a, std::memory_order order = std::memory_order_seq_cst) {
+        return value_type(val.exchange(a.value(), order), typename value_type::unchecked_tag());
+    }
+
+    // on failure, expected is set to the current value
+    bool compare_exchange_weak (value_type& expected, const value_type& desired,
+                                std::memory_order success, std::memory_order failure) {
+        T current = expected.value();
+        bool done = val.compare_exchange_weak(current, desired.value(), success, failure);
+
+        expected = value_type(current, typename value_type::unchecked_tag());
+        return done;
+    }
+
+    bool compare_exchange_weak (value_type& expected, const value_type& desired,
+                                std::memory_order order = std::memory_order_seq_cst) {
+        return compare_exchange_weak(expected, desired, order, atomic_type_order::failure_order(order));
+    }
+
+    bool compare_exchange_strong (value_type& expected, const value_type& desired,
+                                  std::memory_order success, std::memory_order failure) {
+        T current = expected.value();
+        bool done = val.compare_exchange_strong(current, desired.value(), success, failure);
+
+        expected = value_type(current, typename value_type::unchecked_tag());
+        return done;
+    }
+
+    bool compare_exchange_strong (value_type& expected, const value_type& desired,
+                                  std::memory_order order = std::memory_order_seq_cst) {
+        return compare_exchange_strong(expected, desired, order, atomic_type_order::failure_order(order));
+    }
+
+    // both give the value held before the operation, with the status under Status_On_Violation
+    result_type fetch_add (T a, std::memory_order order = std::memory_order_seq_cst) {
+        T old = val.load(std::memory_order_relaxed);
+
+        for (;;) {
+            result_type r = value_type::val_add(old, a, old);
+
+            if (!stores(r) || val.compare_exchange_weak(old, value_type::value_of(r), order, std::memory_order_relaxed)) {
+                return value_type::with_value(old, r);
+            }
+        }
+    }
+
+    result_type fetch_sub (T a, std::memory_order order = std::memory_order_seq_cst) {
+        T old = val.load(std::memory_order_relaxed);
+
+        for (;;) {
+            result_type r = value_type::val_sub(old, a, old);
+
+            if (!stores(r) || val.compare_exchange_weak(old, value_type::value_of(r), order, std::memory_order_relaxed)) {
+                return value_type::with_value(old, r);
+            }
+        }
+    }
+
+private:
+    // a full T whatever value_type::storage_type is, so the compare exchange loops work on T
+    std::atomic<T> val;
+
+    // whether the result of an operation is to be stored, only a reported failure is not
+    static bool stores (const value_type&) {
+        return true;
+    }
+
+    static bool stores (const Range_Result<value_type>& r) {
+        return r.ok();
+    }
+};
+
+#endif // ATOMIC_TYPE_H_INCLUDED
@@ -0,0 +1,1150 @@
+/* Benchmarks of Mod_Type, Range_Type, Ranged_Ptr and their atomic versions against plain integers and pointers
+ *
+ * Usage : bench [--json file] [--filter text] [--min-time milliseconds]
+ *     --json      also writes the results as JSON to file
+ *     --filter    only runs benchmarks whose name contains text
+ *     --min-time  time spent on each measurement, 50 by default
+ *
+ * Each benchmark runs a loop of independent operations over pregenerated inputs,
+ * and reports the median and minimum time per operation over several measurements
+ * Benchmarks named raw_* are the plain integer/pointer baselines, the others report their ratio to the baseline
+ * Benchmarks ending in _tN share one counter between N threads, and report the total time over all threads
+ * Range_Vector and Packed_Range_Array benchmarks count one value read or written as one operation
+ * Transform benchmarks count one value transformed, or one coefficient produced, as one operation,
+ * and matrix benchmarks one whole product
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../atomic_type.h"
+#include "../mod_array.h"
+#include "../mod_matrix.h"
+#include "../mod_ntt.h"
+#include "../mod_ring.h"
+#include "../mod_type.h"
+#include "../packed_range_array.h"
+#include "../range_type.h"
+#include "../range_vector.h"
+#include "../ranged_ptr.h"
+
+// keeps the compiler from discarding a result
+template <typename T>
+inline void escape (const T& a) {
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(a) : "memory");
+#else
+    static volatile T sink;
+    sink = a;
+#endif
+}
+
+struct Benchmark {
+    std::string name;
+    std::string baseline;       // empty for the baselines themselves
+    std::function<void (std::size_t)> run;      // performs the given number of operations
+};
+
+struct Result {
+    std::string name;
+    std::string baseline;
+    std::size_t iterations;
+    double ns_per_op;           // median
+    double ns_per_op_min;
+};
+
+static const std::size_t input_size = 4096;     // power of two, inputs are indexed with i & (input_size - 1)
+static const std::size_t input_mask = input_size - 1;
+
+static double seconds_for (const Benchmark& b, std::size_t iterations) {
+    auto start = std::chrono::steady_clock::now();
+    b.run(iterations);
+    auto stop = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double>(stop - start).count();
+}
+
+static Result measure (const Benchmark& b, double min_time) {
+    const int repeats = 5;
+
+    // grow the iteration count until one run takes a tenth of the target time
+    // the first run only warms up caches and branch predictors
+    std::size_t iterations = 1024;
+    double elapsed = seconds_for(b, iterations);
+    elapsed = seconds_for(b, iterations);
+    while (elapsed < min_time / 10 && iterations < (std::size_t(1) << 40)) {
+        iterations *= 2;
+        elapsed = seconds_for(b, iterations);
+    }
+    iterations = std::max<std::size_t>(1024, std::size_t(double(iterations) * min_time / std::max(elapsed, 1e-9)));
+
+    std::vector<double> ns;
+    for (int i = 0; i < repeats; i++) {
+        ns.push_back(seconds_for(b, iterations) * 1e9 / double(iterations));
+    }
+    std::sort(ns.begin(), ns.end());
+
+    return Result { b.name, b.baseline, iterations, ns[repeats / 2], ns[0] };
+}
+
+// ---- inputs ----
+
+template <typename T>
+static std::vector<T> random_values (long long low, long long high, unsigned seed) {
+    std::mt19937_64 gen(seed);
+    std::uniform_int_distribution<long long> dist(low, high);
+    std::vector<T> values(input_size);
+
+    for (auto& v : values) {
+        v = T(dist(gen));
+    }
+
+    return values;
+}
+
+// ---- Mod_Type ----
+
+static const long long modulus = 1000000007;
+using Mod = Mod_Type<unsigned int, modulus>;
+
+static void add_mod_type (std::vector<Benchmark>& list) {
+    auto x = std::make_shared<std::vector<unsigned int>>(random_values<unsigned int>(0, modulus - 1, 1));
+    auto y = std::make_shared<std::vector<unsigned int>>(random_values<unsigned int>(0, modulus - 1, 2));
+    auto mx = std::make_shared<std::vector<Mod>>(x->begin(), x->end());
+    auto my = std::make_shared<std::vector<Mod>>(y->begin(), y->end());
+
+    list.push_back({ "raw_int_add", "", [=] (std::size_t n) {
+        unsigned int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            acc ^= (*x)[i & input_mask] + (*y)[i & input_mask];
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "raw_int_mul", "", [=] (std::size_t n) {
+        unsigned int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            acc ^= (*x)[i & input_mask] * (*y)[i & input_mask];
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "raw_int_add_mod", "", [=] (std::size_t n) {
+        unsigned int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            unsigned long long s = (unsigned long long) (*x)[i & input_mask] + (*y)[i & input_mask];
+            acc ^= (unsigned int) (s % modulus);
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "raw_int_mul_mod", "", [=] (std::size_t n) {
+        unsigned int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            unsigned long long p = (unsigned long long) (*x)[i & input_mask] * (*y)[i & input_mask];
+            acc ^= (unsigned int) (p % modulus);
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "mod_type_add", "raw_int_add_mod", [=] (std::size_t n) {
+        unsigned int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            acc ^= ((*mx)[i & input_mask] + (*my)[i & input_mask]).value();
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "mod_type_sub", "raw_int_add_mod", [=] (std::size_t n) {
+        unsigned int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            acc ^= ((*mx)[i & input_mask] - (*my)[i & input_mask]).value();
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "mod_type_mul", "raw_int_mul_mod", [=] (std::size_t n) {
+        unsigned int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            acc ^= ((*mx)[i & input_mask] * (*my)[i & input_mask]).value();
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "mod_type_add_raw_int", "raw_int_add_mod", [=] (std::size_t n) {
+        unsigned int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            acc ^= ((*mx)[i & input_mask] + (*y)[i & input_mask]).value();
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "mod_type_add_assign", "raw_int_add_mod", [=] (std::size_t n) {
+        Mod acc;
+        for (std::size_t i = 0; i < n; i++) {
+            acc += (*my)[i & input_mask];
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "mod_type_increment", "raw_int_add_mod", [=] (std::size_t n) {
+        unsigned int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            Mod a = (*mx)[i & input_mask];
+            ++a;
+            acc ^= a.value();
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "mod_type_sub_assign", "raw_int_add_mod", [=] (std::size_t n) {
+        unsigned int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            Mod a = (*mx)[i & input_mask];
+            a -= (*my)[i & input_mask];
+            acc ^= a.value();
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "mod_type_mul_assign", "raw_int_mul_mod", [=] (std::size_t n) {
+        unsigned int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            Mod a = (*mx)[i & input_mask];
+            a *= (*my)[i & input_mask];
+            acc ^= a.value();
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "mod_type_decrement", "raw_int_add_mod", [=] (std::size_t n) {
+        unsigned int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            Mod a = (*mx)[i & input_mask];
+            --a;
+            acc ^= a.value();
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "raw_int_equal", "", [=] (std::size_t n) {
+        unsigned int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            acc += (*x)[i & input_mask] == (*y)[i & input_mask];
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "mod_type_equal", "raw_int_equal", [=] (std::size_t n) {
+        unsigned int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            acc += (*mx)[i & input_mask] == (*my)[i & input_mask];
+        }
+        escape(acc);
+    } });
+
+    // exponentiation and inversion, on nonzero values so that every value has an inverse
+    auto nx  = std::make_shared<std::vector<unsigned int>>(random_values<unsigned int>(1, modulus - 1, 3));
+    auto nmx = std::make_shared<std::vector<Mod>>(nx->begin(), nx->end());
+
+    auto raw_pow = [] (unsigned long long a, unsigned long long e) {
+        unsigned long long acc = 1;
+        for (; e != 0; e >>= 1) {
+            if ((e & 1) != 0) {
+                acc = acc * a % modulus;
+            }
+            a = a * a % modulus;
+        }
+        return (unsigned int) acc;
+    };
+
+    list.push_back({ "raw_int_pow_mod", "", [=] (std::size_t n) {
+        unsigned int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            acc ^= raw_pow((*x)[i & input_mask], (*y)[i & input_mask]);
+        }
+        escape(acc);
+    } });
+
+    // Fermat's little theorem, a^-1 = a^(modulus - 2)
+    list.push_back({ "raw_int_inverse_mod", "", [=] (std::size_t n) {
+        unsigned int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            acc ^= raw_pow((*nx)[i & input_mask], modulus - 2);
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "mod_type_pow", "raw_int_pow_mod", [=] (std::size_t n) {
+        unsigned int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            acc ^= (*mx)[i & input_mask].pow((*y)[i & input_mask]).value();
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "mod_type_inverse", "raw_int_inverse_mod", [=] (std::size_t n) {
+        unsigned int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            acc ^= (*nmx)[i & input_mask].inverse().value();
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "mod_batch_inverse", "raw_int_inverse_mod", [=] (std::size_t n) {
+        std::vector<unsigned int> out(input_size);
+        unsigned int acc = 0;
+        for (std::size_t i = 0; i < n; i += input_size) {
+            std::size_t len = n - i < input_size ? n - i : input_size;
+            Mod_Batch<unsigned int, modulus>::inverse(nx->data(), out.data(), len);
+            acc ^= out[len - 1];
+        }
+        escape(acc);
+    } });
+
+    // modulus of 2^32, the same wraparound as unsigned int itself
+    using Wrap = Mod_Type<unsigned int, 0>;
+    auto wx = std::make_shared<std::vector<Wrap>>(x->begin(), x->end());
+    auto wy = std::make_shared<std::vector<Wrap>>(y->begin(), y->end());
+
+    list.push_back({ "mod_type_wrap_add", "raw_int_add", [=] (std::size_t n) {
+        unsigned int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            acc ^= ((*wx)[i & input_mask] + (*wy)[i & input_mask]).value();
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "mod_type_wrap_mul", "raw_int_mul", [=] (std::size_t n) {
+        unsigned int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            acc ^= ((*wx)[i & input_mask] * (*wy)[i & input_mask]).value();
+        }
+        escape(acc);
+    } });
+}
+
+// ---- Range_Type ----
+
+using Range = Range_Type<int, -1000000, 1000000>;
+using Full  = No_Wrap<int>;
+
+static void add_range_type (std::vector<Benchmark>& list) {
+    auto x = std::make_shared<std::vector<int>>(random_values<int>(-1000, 1000, 3));
+    auto y = std::make_shared<std::vector<int>>(random_values<int>(-1000, 1000, 4));
+    auto rx = std::make_shared<std::vector<Range>>(x->begin(), x->end());
+    auto ry = std::make_shared<std::vector<Range>>(y->begin(), y->end());
+
+    // a + INT_MIN with a >= 0, the edge where negating b would overflow
+    auto edge_a = std::make_shared<std::vector<int>>(random_values<int>(0, INT_MAX, 5));
+
+    list.push_back({ "raw_int_range_add", "", [=] (std::size_t n) {
+        int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            acc ^= (*x)[i & input_mask] + (*y)[i & input_mask];
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "raw_int_range_mul", "", [=] (std::size_t n) {
+        int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            acc ^= (*x)[i & input_mask] * (*y)[i & input_mask];
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "range_type_add", "raw_int_range_add", [=] (std::size_t n) {
+        int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            acc ^= Range((*rx)[i & input_mask] + (*ry)[i & input_mask]).value();
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "range_type_sub", "raw_int_range_add", [=] (std::size_t n) {
+        int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            acc ^= Range((*rx)[i & input_mask] - (*ry)[i & input_mask]).value();
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "range_type_mul", "raw_int_range_mul", [=] (std::size_t n) {
+        int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            acc ^= Range((*rx)[i & input_mask] * (*ry)[i & input_mask]).value();
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "range_type_add_raw_int", "raw_int_range_add", [=] (std::size_t n) {
+        int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            acc ^= Range((*rx)[i & input_mask] + (*y)[i & input_mask]).value();
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "range_type_add_assign", "raw_int_range_add", [=] (std::size_t n) {
+        int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            Range a = (*rx)[i & input_mask];
+            a += (*ry)[i & input_mask];
+            acc ^= a.value();
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "range_type_increment", "raw_int_range_add", [=] (std::size_t n) {
+        int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            Range a = (*rx)[i & input_mask];
+            ++a;
+            acc ^= a.value();
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "range_type_sub_assign", "raw_int_range_add", [=] (std::size_t n) {
+        int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            Range a = (*rx)[i & input_mask];
+            a -= (*ry)[i & input_mask];
+            acc ^= a.value();
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "range_type_mul_assign", "raw_int_range_mul", [=] (std::size_t n) {
+        int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            Range a = (*rx)[i & input_mask];
+            a *= (*ry)[i & input_mask];
+            acc ^= a.value();
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "raw_int_range_equal", "", [=] (std::size_t n) {
+        int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            acc += (*x)[i & input_mask] == (*y)[i & input_mask];
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "range_type_equal", "raw_int_range_equal", [=] (std::size_t n) {
+        int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            acc += (*rx)[i & input_mask] == (*ry)[i & input_mask];
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "raw_int_add_int_min", "", [=] (std::size_t n) {
+        int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            acc ^= (*edge_a)[i & input_mask] + INT_MIN;
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "range_type_add_int_min", "raw_int_add_int_min", [=] (std::size_t n) {
+        int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            acc ^= Full(Full((*edge_a)[i & input_mask]) + INT_MIN).value();
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "range_type_sub_int_min", "raw_int_add_int_min", [=] (std::size_t n) {
+        int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            acc ^= Full(Full(-(*edge_a)[i & input_mask] - 1) - INT_MIN).value();
+        }
+        escape(acc);
+    } });
+
+    // n is rounded up to whole passes over the range
+    list.push_back({ "raw_int_for_loop", "", [=] (std::size_t n) {
+        int acc = 0;
+        for (std::size_t done = 0; done < n; done += 1000) {
+            for (int v = 0; v < 1000; v++) {
+                escape(v);
+                acc ^= v;
+            }
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "range_type_range_for", "raw_int_for_loop", [=] (std::size_t n) {
+        int acc = 0;
+        for (std::size_t done = 0; done < n; done += 1000) {
+            for (int v : Range_Type<int, 0, 999>()) {
+                escape(v);
+                acc ^= v;
+            }
+        }
+        escape(acc);
+    } });
+}
+
+// ---- Ranged_Ptr ----
+
+struct Block {
+    unsigned char bytes[256];
+};
+
+static void add_ranged_ptr (std::vector<Benchmark>& list) {
+    auto block = std::make_shared<Block>();
+    for (int i = 0; i < 256; i++) {
+        block->bytes[i] = (unsigned char) (i * 7);
+    }
+    auto index = std::make_shared<std::vector<int>>(random_values<int>(0, 255, 6));
+
+    // n is rounded up to whole passes over the block
+    list.push_back({ "raw_ptr_increment", "", [=] (std::size_t n) {
+        unsigned int acc = 0;
+        for (std::size_t done = 0; done < n; done += 255) {
+            unsigned char* p = block->bytes;
+            for (int i = 0; i < 255; i++) {
+                acc += *p;
+                ++p;
+                escape(p);
+            }
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "ranged_ptr_increment", "raw_ptr_increment", [=] (std::size_t n) {
+        unsigned int acc = 0;
+        for (std::size_t done = 0; done < n; done += 255) {
+            Ranged_Ptr<Block> p(*block);
+            for (int i = 0; i < 255; i++) {
+                acc += *p;
+                ++p;
+            }
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "raw_ptr_index", "", [=] (std::size_t n) {
+        unsigned int acc = 0;
+        unsigned char* p = block->bytes;
+        escape(p);
+        for (std::size_t i = 0; i < n; i++) {
+            acc += p[(*index)[i & input_mask]];
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "ranged_ptr_index", "raw_ptr_index", [=] (std::size_t n) {
+        unsigned int acc = 0;
+        Ranged_Ptr<Block> p(*block);
+        for (std::size_t i = 0; i < n; i++) {
+            acc += p[(*index)[i & input_mask]];
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "raw_ptr_add_assign", "", [=] (std::size_t n) {
+        unsigned int acc = 0;
+        unsigned char* p = block->bytes;
+        for (std::size_t i = 0; i < n; i++) {
+            int d = (*index)[i & input_mask];
+            p += d;
+            escape(p);
+            acc += *p;
+            p -= d;
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "ranged_ptr_add_assign", "raw_ptr_add_assign", [=] (std::size_t n) {
+        unsigned int acc = 0;
+        Ranged_Ptr<Block> p(*block);
+        for (std::size_t i = 0; i < n; i++) {
+            int d = (*index)[i & input_mask];
+            p += d;
+            acc += *p;
+            p -= d;
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "raw_ptr_load_u32", "", [=] (std::size_t n) {
+        unsigned int acc = 0;
+        unsigned char* p = block->bytes;
+        escape(p);
+        for (std::size_t i = 0; i < n; i++) {
+            uint32_t v;
+            std::memcpy(&v, p + ((*index)[i & input_mask] & 0xFC), sizeof(v));
+            acc += v;
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "ranged_ptr_load_u32", "raw_ptr_load_u32", [=] (std::size_t n) {
+        unsigned int acc = 0;
+        Ranged_Ptr<Block> p(*block);
+        for (std::size_t i = 0; i < n; i++) {
+            acc += p.load<uint32_t>((*index)[i & input_mask] & 0xFC);
+        }
+        escape(acc);
+    } });
+}
+
+// ---- atomic types under contention ----
+
+// splits n operations over the given number of threads, each doing op(count)
+template <typename Op>
+static void in_threads (int threads, std::size_t n, Op op) {
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back(op, n / threads + (std::size_t(t) < n % threads ? 1 : 0));
+    }
+
+    for (auto& w : workers) {
+        w.join();
+    }
+}
+
+static void add_atomic (std::vector<Benchmark>& list) {
+    using Mod_Pow2 = Mod_Type<unsigned int, 1024>;
+
+    for (int threads : { 1, 2, 4, 8 }) {
+        std::string suffix = "_t" + std::to_string(threads);
+        std::string raw    = "raw_atomic_add" + suffix;
+
+        list.push_back({ raw, "", [=] (std::size_t n) {
+            auto c = std::make_shared<std::atomic<unsigned int>>(0);
+            in_threads(threads, n, [=] (std::size_t count) {
+                for (std::size_t i = 0; i < count; i++) {
+                    c->fetch_add(1);
+                }
+            });
+            escape(c->load());
+        } });
+
+        // what the atomic types replace
+        list.push_back({ "mutex_mod_type_add" + suffix, raw, [=] (std::size_t n) {
+            auto m = std::make_shared<std::mutex>();
+            auto c = std::make_shared<Mod>();
+            in_threads(threads, n, [=] (std::size_t count) {
+                for (std::size_t i = 0; i < count; i++) {
+                    std::lock_guard<std::mutex> lock(*m);
+                    *c += Mod(1);
+                }
+            });
+            escape(c->value());
+        } });
+
+        list.push_back({ "atomic_mod_type_add" + suffix, raw, [=] (std::size_t n) {
+            auto c = std::make_shared<Atomic_Mod_Type<unsigned int, modulus>>();
+            in_threads(threads, n, [=] (std::size_t count) {
+                for (std::size_t i = 0; i < count; i++) {
+                    c->fetch_add(Mod(1));
+                }
+            });
+            escape(c->load().value());
+        } });
+
+        list.push_back({ "atomic_mod_type_pow2_add" + suffix, raw, [=] (std::size_t n) {
+            auto c = std::make_shared<Atomic_Mod_Type<unsigned int, 1024>>();
+            in_threads(threads, n, [=] (std::size_t count) {
+                for (std::size_t i = 0; i < count; i++) {
+                    c->fetch_add(Mod_Pow2(1));
+                }
+            });
+            escape(c->load().value());
+        } });
+
+        // each thread adds before it subtracts, so the count stays in [0, threads]
+        list.push_back({ "atomic_range_type_add" + suffix, raw, [=] (std::size_t n) {
+            auto c = std::make_shared<Atomic_Range_Type<int, 0, 64>>();
+            in_threads(threads, n, [=] (std::size_t count) {
+                for (std::size_t i = 0; i < count; i++) {
+                    if (i & 1) {
+                        c->fetch_sub(1);
+                    }
+                    else {
+                        c->fetch_add(1);
+                    }
+                }
+            });
+            escape(c->load().value());
+        } });
+    }
+}
+
+// ---- Range_Vector, bulk loads of values in [0, 1000], one value stored counting as one operation ----
+// loads of the 16 KiB inputs stay in cache, loads of a 32 MiB column do not
+
+static void add_range_vector (std::vector<Benchmark>& list) {
+    static const std::size_t column_size = std::size_t(1) << 23;
+
+    using Column = Range_Vector<int, 0, 1000>;
+
+    auto x      = std::make_shared<std::vector<int>>(random_values<int>(0, 1000, 7));
+    auto column = std::make_shared<std::vector<int>>(column_size);
+    for (std::size_t i = 0; i < column_size; i++) {
+        (*column)[i] = (*x)[i & input_mask];
+    }
+
+    // the destinations are kept between runs, so neither allocation nor page faults are timed
+    auto plain_out = std::make_shared<std::vector<int>>();
+    auto range_out = std::make_shared<Column>();
+    plain_out->reserve(column_size);
+    range_out->reserve(column_size);
+
+    // n is rounded up to whole copies of the inputs
+    list.push_back({ "raw_int_vector_assign", "", [=] (std::size_t n) {
+        for (std::size_t done = 0; done < n; done += input_size) {
+            plain_out->assign(x->begin(), x->end());
+            escape(plain_out->back());
+        }
+    } });
+
+    list.push_back({ "range_vector_assign", "raw_int_vector_assign", [=] (std::size_t n) {
+        for (std::size_t done = 0; done < n; done += input_size) {
+            range_out->assign(*x);
+            escape(range_out->data()[input_size - 1]);
+        }
+    } });
+
+    // n is rounded up to whole columns
+    list.push_back({ "raw_int_column_assign", "", [=] (std::size_t n) {
+        for (std::size_t done = 0; done < n; done += column_size) {
+            plain_out->assign(column->begin(), column->end());
+            escape(plain_out->back());
+        }
+    } });
+
+    list.push_back({ "range_vector_column_assign", "raw_int_column_assign", [=] (std::size_t n) {
+        for (std::size_t done = 0; done < n; done += column_size) {
+            range_out->assign(*column);
+            escape(range_out->data()[column_size - 1]);
+        }
+    } });
+}
+
+// ---- Packed_Range_Array, 10 bit values in a table of 2^20, one value read or written counting as one operation ----
+
+static void add_packed (std::vector<Benchmark>& list) {
+    static const std::size_t table_size = std::size_t(1) << 20;
+
+    using Packed = Packed_Range_Array<int, 0, 1000>;
+
+    auto x     = std::make_shared<std::vector<int>>(random_values<int>(0, 1000, 7));
+    auto index = std::make_shared<std::vector<int>>(random_values<int>(0, table_size - 1, 8));
+    auto plain = std::make_shared<std::vector<int>>(table_size);
+    for (std::size_t i = 0; i < table_size; i++) {
+        (*plain)[i] = (*x)[i & input_mask];
+    }
+    auto packed = std::make_shared<Packed>();
+    packed->assign(*plain);
+
+    list.push_back({ "raw_int_table_sum", "", [=] (std::size_t n) {
+        unsigned int acc = 0;
+        const int* p = plain->data();
+        escape(p);
+        for (std::size_t i = 0; i < n; i++) {
+            acc += (unsigned int) p[i & (table_size - 1)];
+        }
+        escape(acc);
+    } });
+
+    // n is rounded up to whole blocks of 256
+    list.push_back({ "packed_range_decode_sum", "raw_int_table_sum", [=] (std::size_t n) {
+        unsigned int acc = 0;
+        int block[256];
+        for (std::size_t done = 0; done < n; done += 256) {
+            packed->decode(done & (table_size - 1), 256, block);
+            for (int k = 0; k < 256; k++) {
+                acc += (unsigned int) block[k];
+            }
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "packed_range_iterate_sum", "raw_int_table_sum", [=] (std::size_t n) {
+        unsigned int acc = 0;
+        for (std::size_t done = 0; done < n; done += table_size) {
+            std::size_t len = n - done < table_size ? n - done : table_size;
+            for (auto it = packed->begin(), end = packed->begin() + len; it != end; ++it) {
+                acc += (unsigned int) (*it).value();
+            }
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "raw_int_table_lookup", "", [=] (std::size_t n) {
+        unsigned int acc = 0;
+        const int* p = plain->data();
+        escape(p);
+        for (std::size_t i = 0; i < n; i++) {
+            acc += (unsigned int) p[(*index)[i & input_mask]];
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "packed_range_lookup", "raw_int_table_lookup", [=] (std::size_t n) {
+        unsigned int acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            acc += (unsigned int) (*packed)[(*index)[i & input_mask]].value();
+        }
+        escape(acc);
+    } });
+
+    // n is rounded up to whole copies of the inputs
+    list.push_back({ "raw_int_table_store", "", [=] (std::size_t n) {
+        std::vector<int> out;
+        out.reserve(table_size);
+        for (std::size_t done = 0; done < n; done += input_size) {
+            if (out.size() == table_size) {
+                out.clear();
+            }
+            out.insert(out.end(), x->begin(), x->end());
+            escape(out.back());
+        }
+    } });
+
+    list.push_back({ "packed_range_append", "raw_int_table_store", [=] (std::size_t n) {
+        Packed out;
+        out.reserve(table_size);
+        for (std::size_t done = 0; done < n; done += input_size) {
+            if (out.size() == table_size) {
+                out.clear();
+            }
+            out.append(*x);
+            escape(out[0]);
+        }
+    } });
+}
+
+// ---- rings, one thread pushing then popping ----
+// the rings are static, as heap allocation only honours their alignment from C++17 onwards
+
+static void add_ring (std::vector<Benchmark>& list) {
+    static const std::size_t slots = 1024;
+
+    // plain array with masked indices, no synchronisation
+    list.push_back({ "raw_ring_push_pop", "", [=] (std::size_t n) {
+        std::vector<std::size_t> ring(slots);
+        std::size_t head = 0, tail = 0, acc = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            ring[tail & (slots - 1)] = i;
+            tail++;
+            escape(ring);
+            acc += ring[head & (slots - 1)];
+            head++;
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "spsc_ring_push_pop", "raw_ring_push_pop", [=] (std::size_t n) {
+        static Spsc_Ring<std::size_t, slots> ring;
+        std::size_t acc = 0, v = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            ring.try_push(i);
+            ring.try_pop(v);
+            acc += v;
+        }
+        escape(acc);
+    } });
+
+    list.push_back({ "mpmc_ring_push_pop", "raw_ring_push_pop", [=] (std::size_t n) {
+        static Mpmc_Ring<std::size_t, slots> ring;
+        std::size_t acc = 0, v = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            ring.try_push(i);
+            ring.try_pop(v);
+            acc += v;
+        }
+        escape(acc);
+    } });
+}
+
+// ---- number theoretic transform, one value transformed or one coefficient produced counting as one operation ----
+
+static const long long ntt_modulus = 998244353;         // 119 * 2^23 + 1
+using Ntt_Mod = Mod_Type<unsigned int, ntt_modulus>;
+
+static void add_ntt (std::vector<Benchmark>& list) {
+    static const std::size_t size = 4096;
+    static const std::size_t conv = 1024;
+
+    auto x  = std::make_shared<std::vector<unsigned int>>(random_values<unsigned int>(0, ntt_modulus - 1, 4));
+    auto mx = std::make_shared<std::vector<Ntt_Mod>>(x->begin(), x->end());
+    auto ntt = std::make_shared<Mod_Ntt<unsigned int, ntt_modulus>>(size);
+
+    // textbook iterative radix-2 transform, bit reversal then butterflies with twiddles computed on the fly
+    list.push_back({ "raw_int_ntt", "", [=] (std::size_t n) {
+        std::vector<unsigned long long> a(size);
+        for (std::size_t done = 0; done < n; done += size) {
+            std::copy(x->begin(), x->begin() + size, a.begin());
+
+            for (std::size_t i = 1, j = 0; i < size; i++) {
+                std::size_t bit = size >> 1;
+                for (; j & bit; bit >>= 1) {
+                    j ^= bit;
+                }
+                j ^= bit;
+                if (i < j) {
+                    std::swap(a[i], a[j]);
+                }
+            }
+
+            for (std::size_t len = 2; len <= size; len *= 2) {
+                unsigned long long w_len = 1, base = 3, e = (ntt_modulus - 1) / len;     // 3 generates the group
+                for (; e != 0; e >>= 1, base = base * base % ntt_modulus) {
+                    if (e & 1) {
+                        w_len = w_len * base % ntt_modulus;
+                    }
+                }
+                for (std::size_t s = 0; s < size; s += len) {
+                    unsigned long long w = 1;
+                    for (std::size_t j = 0; j < len / 2; j++) {
+                        unsigned long long u = a[s + j];
+                        unsigned long long v = a[s + j + len / 2] * w % ntt_modulus;
+                        a[s + j]           = (u + v) % ntt_modulus;
+                        a[s + j + len / 2] = (u + ntt_modulus - v) % ntt_modulus;
+                        w = w * w_len % ntt_modulus;
+                    }
+                }
+            }
+
+            escape(a[0]);
+        }
+    } });
+
+    list.push_back({ "mod_ntt_transform", "raw_int_ntt", [=] (std::size_t n) {
+        std::vector<Ntt_Mod> a(size);
+        for (std::size_t done = 0; done < n; done += size) {
+            std::copy(mx->begin(), mx->begin() + size, a.begin());
+            ntt->transform(a);
+            escape(a[0]);
+        }
+    } });
+
+    // schoolbook product of two polynomials with conv coefficients each
+    list.push_back({ "raw_int_convolve", "", [=] (std::size_t n) {
+        std::vector<unsigned long long> c(2 * conv - 1);
+        for (std::size_t done = 0; done < n; done += c.size()) {
+            std::fill(c.begin(), c.end(), 0);
+            for (std::size_t i = 0; i < conv; i++) {
+                for (std::size_t j = 0; j < conv; j++) {
+                    c[i + j] = (c[i + j] + (unsigned long long) (*x)[i] * (*x)[conv + j]) % ntt_modulus;
+                }
+            }
+            escape(c[0]);
+        }
+    } });
+
+    list.push_back({ "mod_ntt_convolve", "raw_int_convolve", [=] (std::size_t n) {
+        std::vector<Ntt_Mod> a(mx->begin(), mx->begin() + conv);
+        std::vector<Ntt_Mod> b(mx->begin() + conv, mx->begin() + 2 * conv);
+        for (std::size_t done = 0; done < n; done += 2 * conv - 1) {
+            std::vector<Ntt_Mod> c = ntt->convolve(a, b);
+            escape(c[0]);
+        }
+    } });
+}
+
+// ---- matrix multiplication, one product of two 64 x 64 matrices counting as one operation ----
+// single threaded, a product this size stays on the calling thread
+
+static void add_matrix (std::vector<Benchmark>& list) {
+    static const std::size_t dim = 64;
+
+    using Matrix = Mod_Matrix<unsigned int, modulus>;
+
+    auto x = std::make_shared<std::vector<unsigned int>>(random_values<unsigned int>(0, modulus - 1, 5));
+    auto a = std::make_shared<Matrix>(dim, dim);
+    auto b = std::make_shared<Matrix>(dim, dim);
+
+    for (std::size_t i = 0; i < dim * dim; i++) {
+        a->set(i / dim, i % dim, Mod((*x)[i & input_mask]));
+        b->set(i % dim, i / dim, Mod((*x)[(i * 7) & input_mask]));
+    }
+
+    list.push_back({ "raw_int_matmul", "", [=] (std::size_t n) {
+        std::vector<unsigned int> c(dim * dim);
+        const unsigned int* pa = a->data();
+        const unsigned int* pb = b->data();
+        for (std::size_t done = 0; done < n; done++) {
+            for (std::size_t i = 0; i < dim; i++) {
+                for (std::size_t j = 0; j < dim; j++) {
+                    unsigned long long s = 0;
+                    for (std::size_t p = 0; p < dim; p++) {
+                        s = (s + (unsigned long long) pa[i * dim + p] * pb[p * dim + j]) % modulus;
+                    }
+                    c[i * dim + j] = (unsigned int) s;
+                }
+            }
+            escape(c[0]);
+        }
+    } });
+
+    // what Mod_Matrix replaces, nested loops of Mod_Type
+    list.push_back({ "mod_type_matmul_loops", "raw_int_matmul", [=] (std::size_t n) {
+        std::vector<Mod> c(dim * dim);
+        for (std::size_t done = 0; done < n; done++) {
+            for (std::size_t i = 0; i < dim; i++) {
+                for (std::size_t j = 0; j < dim; j++) {
+                    Mod s;
+                    for (std::size_t p = 0; p < dim; p++) {
+                        s += (*a)(i, p) * (*b)(p, j);
+                    }
+                    c[i * dim + j] = s;
+                }
+            }
+            escape(c[0]);
+        }
+    } });
+
+    list.push_back({ "mod_matrix_mul", "raw_int_matmul", [=] (std::size_t n) {
+        for (std::size_t done = 0; done < n; done++) {
+            Matrix c = *a * *b;
+            escape(c.data()[0]);
+        }
+    } });
+}
+
+// ---- output ----
+
+static std::string compiler () {
+#if defined(__clang__)
+    return std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+    return std::string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+    return "msvc " + std::to_string(_MSC_VER);
+#else
+    return "unknown";
+#endif
+}
+
+static const Result* find (const std::vector<Result>& results, const std::string& name) {
+    for (const auto& r : results) {
+        if (r.name == name) {
+            return &r;
+        }
+    }
+    return nullptr;
+}
+
+static void write_json (std::ostream& out, const std::vector<Result>& results, double min_time) {
+    out << "{\n";
+    out << "  \"context\": {\n";
+    out << "    \"compiler\": \"" << compiler() << "\",\n";
+    out << "    \"cplusplus\": " << __cplusplus << ",\n";
+    out << "    \"min_time_ms\": " << min_time * 1000 << "\n";
+    out << "  },\n";
+    out << "  \"benchmarks\": [\n";
+
+    for (std::size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        const Result* base = find(results, r.baseline);
+
+        out << "    { \"name\": \"" << r.name << "\"";
+        out << ", \"iterations\": " << r.iterations;
+        out << ", \"ns_per_op\": " << r.ns_per_op;
+        out << ", \"ns_per_op_min\": " << r.ns_per_op_min;
+        out << ", \"ops_per_sec\": " << 1e9 / r.ns_per_op;
+        if (base != nullptr) {
+            out << ", \"baseline\": \"" << base->name << "\"";
+            out << ", \"ratio_to_baseline\": " << r.ns_per_op / base->ns_per_op;
+        }
+        out << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+
+    out << "  ]\n";
+    out << "}\n";
+}
+
+int main (int argc, char** argv) {
+    std::string json_path;
+    std::string filter;
+    double min_time = 0.05;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg == "--json" && i + 1 < argc) {
+            json_path = argv[++i];
+        }
+        else if (arg == "--filter" && i + 1 < argc) {
+            filter = argv[++i];
+        }
+        else if (arg == "--min-time" && i + 1 < argc) {
+            min_time = std::atof(argv[++i]) / 1000;
+        }
+        else {
+            std::cerr << "Usage : " << argv[0] << " [--json file] [--filter text] [--min-time milliseconds]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<Benchmark> list;
+    add_mod_type(list);
+    add_range_type(list);
+    add_ranged_ptr(list);
+    add_atomic(list);
+    add_range_vector(list);
+    add_packed(list);
+    add_ring(list);
+    add_ntt(list);
+    add_matrix(list);
+
+    std::vector<Result> results;
+    std::printf("%-28s %12s %16s %10s\n", "benchmark", "ns/op", "ops/s", "vs raw");
+
+    for (const auto& b : list) {
+        // baselines are kept whenever something that refers to them is run
+        bool wanted = filter.empty() || b.name.find(filter) != std::string::npos;
+        for (const auto& other : list) {
+            if (other.baseline == b.name && (filter.empty() || other.name.find(filter) != std::string::npos)) {
+                wanted = true;
+            }
+        }
+        if (!wanted) {
+            continue;
+        }
+
+        results.push_back(measure(b, min_time));
+
+        const Result& r = results.back();
+        const Result* base = find(results, r.baseline);
+        std::printf("%-28s %12.3f %16.0f", r.name.c_str(), r.ns_per_op, 1e9 / r.ns_per_op);
+        if (base != nullptr) {
+            std::printf(" %9.2fx", r.ns_per_op / base->ns_per_op);
+        }
+        std::printf("\n");
+    }
+
+    if (!json_path.empty()) {
+        std::ofstream out(json_path);
+        if (!out) {
+            std::cerr << "Failed to open " << json_path << std::endl;
+            return 1;
+        }
+        write_json(out, results, min_time);
+    }
+
+    return 0;
+}
@@ -0,0 +1,605 @@
+/* Optional counters of the checks done by Mod_Type, Range_Type and Ranged_Ptr, per instantiation,
+ * and optional profiles of the values checked by Range_Type, for choosing tighter bounds
+ * Enabled by defining CHECK_STATS and RANGE_PROFILE as 1 respectively before including any of the headers,
+ * otherwise nothing is compiled in
+ * Each thread counts into its own shard without atomic read-modify-write, shards are summed when read
+ *
+ * License:
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#ifndef CHECK_STATS_H_INCLUDED
+#define CHECK_STATS_H_INCLUDED
+
+#ifndef CHECK_STATS
+#define CHECK_STATS 0
+#endif
+
+#ifndef RANGE_PROFILE
+#define RANGE_PROFILE 0
+#endif
+
+#if CHECK_STATS || RANGE_PROFILE
+
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(__GNUC__)
+#define CHECK_STATS_COLD    __attribute__((noinline, cold))
+#elif defined(_MSC_VER)
+#define CHECK_STATS_COLD    __declspec(noinline)
+#else
+#define CHECK_STATS_COLD
+#endif
+
+namespace check_stats {
+    // counting is skipped during constant evaluation, where it is not allowed
+    // without a way to tell, operations used in constant expressions fail to compile with counting enabled
+    constexpr bool counting () {
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+        return !__builtin_is_constant_evaluated();
+#else
+        return true;
+#endif
+#elif defined(_MSC_VER) && _MSC_VER >= 1925
+        return !__builtin_is_constant_evaluated();
+#else
+        return true;
+#endif
+    }
+
+    // One Shard per thread, only ever written by that thread, so increments need no locked instruction
+    // Shard holds atomics so that other threads may read it while it is written, and provides
+    //     static const std::size_t max_sites;
+    //     Shard ();                           // all counts zero
+    //     void add (const Shard& other);      // adds the counts of other, relaxed
+    // Registered sites past max_sites - 1 share the last one
+    template <typename Shard>
+    class Shard_Registry {
+    public:
+        static std::size_t register_site (const std::string& name) {
+            State& s = state();
+            std::lock_guard<std::mutex> guard(s.lock);
+
+            if (s.names.size() + 1 >= Shard::max_sites) {
+                if (s.names.size() + 1 == Shard::max_sites) {
+                    s.names.push_back("(other sites)");
+                }
+                return Shard::max_sites - 1;
+            }
+
+            s.names.push_back(name);
+            return s.names.size() - 1;
+        }
+
+        // a plain pointer is reached directly, without the call guarding the construction of a thread_local object
+        static Shard& local () {
+            thread_local Shard* shard = nullptr;
+
+            if (shard == nullptr) {
+                shard = new_local();
+            }
+
+            return *shard;
+        }
+
+        // sum over all threads, live and exited, into out, and gives the names of the sites registered so far
+        // shards of threads still running are read while they may change, so are only as recent as the read
+        static std::vector<std::string> total (Shard& out) {
+            State& s = state();
+            std::lock_guard<std::mutex> guard(s.lock);
+
+            out.add(s.retired);
+            for (const Shard* shard : s.live) {
+                out.add(*shard);
+            }
+
+            return s.names;
+        }
+
+    private:
+        struct State {
+            std::mutex lock;
+            std::vector<std::string> names;
+            std::vector<const Shard*> live;
+            Shard retired;      // shards of threads that have exited
+        };
+
+        // never destroyed, so threads exiting during static destruction can still retire their shards
+        static State& state () {
+            static State* s = new State();
+            return *s;
+        }
+
+        class Owner {
+        public:
+            Owner () : shard {new Shard()} {
+                std::lock_guard<std::mutex> guard(state().lock);
+                state().live.push_back(shard.get());
+            }
+
+            ~Owner () {
+                State& s = state();
+                std::lock_guard<std::mutex> guard(s.lock);
+
+                s.retired.add(*shard);
+
+                for (std::size_t i = 0; i < s.live.size(); i++) {
+                    if (s.live[i] == shard.get()) {
+                        s.live.erase(s.live.begin() + std::ptrdiff_t(i));
+                        break;
+                    }
+                }
+            }
+
+            std::unique_ptr<Shard> shard;
+        };
+
+        CHECK_STATS_COLD
+        static Shard* new_local () {
+            thread_local Owner owner;
+            return owner.shard.get();
+        }
+    };
+
+    // counts are only written by their own thread
+    inline void bump (std::atomic<unsigned long long>& c, unsigned long long n = 1) {
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    template <typename T>
+    std::string type_name () {
+        return (std::is_signed<T>::value ? "int" : "uint") + std::to_string(std::numeric_limits<T>::digits + std::is_signed<T>::value);
+    }
+
+    inline void append_params (std::ostringstream&) {}
+
+    template <typename P, typename... Rest>
+    void append_params (std::ostringstream& out, const P& p, const Rest&... rest) {
+        out << ", " << p;
+        append_params(out, rest...);
+    }
+
+    // kind<first, params...>, e.g. Range_Type<int32, 0, 100>
+    template <typename... P>
+    std::string site_name (const char* kind, const std::string& first, const P&... params) {
+        std::ostringstream out;
+        out << kind << "<" << first;
+        append_params(out, params...);
+        out << ">";
+        return out.str();
+    }
+}
+
+#endif // CHECK_STATS || RANGE_PROFILE
+
+#if CHECK_STATS
+
+#include <chrono>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define CHECK_STATS_RDTSC 1
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define CHECK_STATS_RDTSC 1
+#else
+#define CHECK_STATS_RDTSC 0
+#endif
+
+// may be defined beforehand, instantiations past this many share the last counters
+#ifndef CHECK_STATS_MAX_SITES
+#define CHECK_STATS_MAX_SITES 256
+#endif
+
+enum class Check_Event {
+    check,              // one value or operation checked
+    overflow,           // result above the range, or a value reduced from above the modulus
+    underflow,          // result below the range, or a value reduced from below 0
+    out_of_bound,       // pointer or access outside the object or buffer
+    slow_path,          // times a violation was handed to the policy or raised
+    slow_path_cycles    // time spent there, in TSC cycles where available, nanoseconds otherwise
+};
+
+// totals of one instantiation
+struct Check_Stats {
+    std::string site;
+    unsigned long long checks;
+    unsigned long long overflows;
+    unsigned long long underflows;
+    unsigned long long out_of_bounds;
+    unsigned long long slow_paths;
+    unsigned long long slow_path_cycles;
+};
+
+namespace check_stats {
+    static const std::size_t events = 6;
+
+    struct Counts {
+        static const std::size_t max_sites = CHECK_STATS_MAX_SITES;
+
+        std::atomic<unsigned long long> counts[max_sites][events];
+
+        Counts () {
+            for (std::size_t s = 0; s < max_sites; s++) {
+                for (std::size_t e = 0; e < events; e++) {
+                    counts[s][e].store(0, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        void add (const Counts& other) {
+            for (std::size_t s = 0; s < max_sites; s++) {
+                for (std::size_t e = 0; e < events; e++) {
+                    bump(counts[s][e], other.counts[s][e].load(std::memory_order_relaxed));
+                }
+            }
+        }
+    };
+
+    using Counts_Registry = Shard_Registry<Counts>;
+
+    inline void add (std::size_t site, Check_Event event, unsigned long long n = 1) {
+        bump(Counts_Registry::local().counts[site][std::size_t(event)], n);
+    }
+
+    // a check, and whether the value checked was below or above the range
+    inline void add_check (std::size_t site, bool under, bool over) {
+        add(site, Check_Event::check);
+
+        if (under || over) {
+            add(site, under ? Check_Event::underflow : Check_Event::overflow);
+        }
+    }
+
+    inline std::size_t register_site (const std::string& name) {
+        return Counts_Registry::register_site(name);
+    }
+
+    inline unsigned long long cycles () {
+#if CHECK_STATS_RDTSC
+        return __rdtsc();
+#else
+        return (unsigned long long) std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    // counts a slow path and the time until it is left, by returning or by throwing
+    class Slow_Path_Timer {
+    public:
+        explicit Slow_Path_Timer (std::size_t site) : site {site}, start {cycles()} {}
+
+        Slow_Path_Timer (const Slow_Path_Timer&) = delete;
+
+        Slow_Path_Timer& operator= (const Slow_Path_Timer&) = delete;
+
+        ~Slow_Path_Timer () {
+            add(site, Check_Event::slow_path);
+            add(site, Check_Event::slow_path_cycles, cycles() - start);
+        }
+
+    private:
+        std::size_t site;
+        unsigned long long start;
+    };
+
+    // totals over all threads of every instantiation used so far
+    inline std::vector<Check_Stats> snapshot () {
+        std::unique_ptr<Counts> total(new Counts());
+        std::vector<std::string> names = Counts_Registry::total(*total);
+        std::vector<Check_Stats> result;
+
+        for (std::size_t s = 0; s < names.size(); s++) {
+            unsigned long long c[events];
+
+            for (std::size_t e = 0; e < events; e++) {
+                c[e] = total->counts[s][e].load(std::memory_order_relaxed);
+            }
+
+            result.push_back(Check_Stats { names[s], c[0], c[1], c[2], c[3], c[4], c[5] });
+        }
+
+        return result;
+    }
+
+    // one line per instantiation
+    inline void dump (std::ostream& out) {
+        out << std::left << std::setw(80) << "site" << std::right
+            << std::setw(14) << "checks"
+            << std::setw(12) << "overflows"
+            << std::setw(12) << "underflows"
+            << std::setw(14) << "out_of_bound"
+            << std::setw(12) << "slow_paths"
+            << std::setw(18) << "slow_path_cycles" << "\n";
+
+        for (const Check_Stats& s : snapshot()) {
+            out << std::left << std::setw(80) << s.site << std::right
+                << std::setw(14) << s.checks
+                << std::setw(12) << s.overflows
+                << std::setw(12) << s.underflows
+                << std::setw(14) << s.out_of_bounds
+                << std::setw(12) << s.slow_paths
+                << std::setw(18) << s.slow_path_cycles << "\n";
+        }
+    }
+}
+
+// site is only evaluated when counting, so may be a call that registers the instantiation on first use
+#define CHECK_STATS_ADD(site, event)                (check_stats::counting() ? check_stats::add((site), (event)) : void())
+#define CHECK_STATS_CHECK(site, under, over)        (check_stats::counting() ? check_stats::add_check((site), (under), (over)) : void())
+
+#else
+
+#define CHECK_STATS_ADD(site, event)                ((void) 0)
+#define CHECK_STATS_CHECK(site, under, over)        ((void) 0)
+
+#endif // CHECK_STATS
+
+#if RANGE_PROFILE
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+// may be defined beforehand, instantiations past this many share the last profile
+#ifndef RANGE_PROFILE_MAX_SITES
+#define RANGE_PROFILE_MAX_SITES 128
+#endif
+
+// may be defined as 0 beforehand to only report through range_profile::report
+// otherwise the report is written at exit to the file named by the environment variable RANGE_PROFILE_FILE,
+// or to stderr when it is not set
+#ifndef RANGE_PROFILE_AT_EXIT
+#define RANGE_PROFILE_AT_EXIT 1
+#endif
+
+// values checked by one instantiation
+// histogram[i] counts values from range_profile::bucket_low(i) to range_profile::bucket_high(i),
+// buckets being 0, and values of each bit length on either side of it
+struct Range_Profile {
+    std::string site;
+    unsigned long long values;
+    long long min;          // only meaningful when values != 0
+    long long max;
+    std::vector<unsigned long long> histogram;
+};
+
+namespace range_profile {
+    static const std::size_t buckets = 128;
+    static const std::size_t zero_bucket = 64;
+
+    inline unsigned bit_length (unsigned long long a) {
+#if defined(__GNUC__)
+        return a == 0 ? 0 : unsigned(64 - __builtin_clzll(a));
+#else
+        unsigned n = 0;
+        for (; a != 0; a >>= 1) {
+            n++;
+        }
+        return n;
+#endif
+    }
+
+    // negative values of bit length b(of their magnitude) in zero_bucket - b, positive ones in zero_bucket + b
+    inline std::size_t bucket (long long a) {
+        return a >= 0 ? zero_bucket + bit_length((unsigned long long) a)
+                      : zero_bucket - bit_length(0ull - (unsigned long long) a);
+    }
+
+    inline long long bucket_low (std::size_t i) {
+        if (i == zero_bucket) {
+            return 0;
+        }
+        if (i > zero_bucket) {
+            return (long long) (1ull << (i - zero_bucket - 1));
+        }
+
+        unsigned b = unsigned(zero_bucket - i);
+        return b == 64 ? LLONG_MIN : -(long long) ((1ull << b) - 1);
+    }
+
+    inline long long bucket_high (std::size_t i) {
+        if (i == zero_bucket) {
+            return 0;
+        }
+        if (i > zero_bucket) {
+            return (long long) ((1ull << (i - zero_bucket)) - 1);
+        }
+
+        unsigned b = unsigned(zero_bucket - i);
+        return b == 64 ? LLONG_MIN : -(long long) (1ull << (b - 1));
+    }
+
+    struct Profiles {
+        static const std::size_t max_sites = RANGE_PROFILE_MAX_SITES;
+
+        struct Site {
+            std::atomic<unsigned long long> values;
+            std::atomic<long long> min;
+            std::atomic<long long> max;
+            std::atomic<unsigned long long> histogram[buckets];
+        };
+
+        Site sites[max_sites];
+
+        Profiles () {
+            for (Site& s : sites) {
+                s.values.store(0, std::memory_order_relaxed);
+                s.min.store(LLONG_MAX, std::memory_order_relaxed);
+                s.max.store(LLONG_MIN, std::memory_order_relaxed);
+
+                for (std::atomic<unsigned long long>& h : s.histogram) {
+                    h.store(0, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        void add (const Profiles& other) {
+            for (std::size_t i = 0; i < max_sites; i++) {
+                Site& s = sites[i];
+                const Site& o = other.sites[i];
+
+                check_stats::bump(s.values, o.values.load(std::memory_order_relaxed));
+
+                if (o.min.load(std::memory_order_relaxed) < s.min.load(std::memory_order_relaxed)) {
+                    s.min.store(o.min.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                }
+                if (o.max.load(std::memory_order_relaxed) > s.max.load(std::memory_order_relaxed)) {
+                    s.max.store(o.max.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                }
+
+                for (std::size_t b = 0; b < buckets; b++) {
+                    check_stats::bump(s.histogram[b], o.histogram[b].load(std::memory_order_relaxed));
+                }
+            }
+        }
+    };
+
+    using Profile_Registry = check_stats::Shard_Registry<Profiles>;
+
+    inline void record_value (std::size_t site, long long a) {
+        Profiles::Site& s = Profile_Registry::local().sites[site];
+
+        check_stats::bump(s.values);
+
+        if (a < s.min.load(std::memory_order_relaxed)) {
+            s.min.store(a, std::memory_order_relaxed);
+        }
+        if (a > s.max.load(std::memory_order_relaxed)) {
+            s.max.store(a, std::memory_order_relaxed);
+        }
+
+        check_stats::bump(s.histogram[bucket(a)]);
+    }
+
+    // values of a 64 bit unsigned T above LLONG_MAX are recorded as LLONG_MAX
+    template <typename T>
+    void record (std::size_t site, T a) {
+        record_value(site, (unsigned long long) a > (unsigned long long) LLONG_MAX && !std::is_signed<T>::value
+                           ? LLONG_MAX : (long long) a);
+    }
+
+    // profiles over all threads of every instantiation used so far
+    inline std::vector<Range_Profile> snapshot () {
+        std::unique_ptr<Profiles> total(new Profiles());
+        std::vector<std::string> names = Profile_Registry::total(*total);
+        std::vector<Range_Profile> result;
+
+        for (std::size_t i = 0; i < names.size(); i++) {
+            const Profiles::Site& s = total->sites[i];
+            Range_Profile p { names[i], s.values.load(std::memory_order_relaxed),
+                              s.min.load(std::memory_order_relaxed), s.max.load(std::memory_order_relaxed),
+                              std::vector<unsigned long long>(buckets) };
+
+            for (std::size_t b = 0; b < buckets; b++) {
+                p.histogram[b] = s.histogram[b].load(std::memory_order_relaxed);
+            }
+
+            result.push_back(p);
+        }
+
+        return result;
+    }
+
+    // smallest integer type holding every value in [min, max]
+    inline const char* smallest_type (long long min, long long max) {
+        if (min >= 0) {
+            return max <= 0xFF ? "uint8" : max <= 0xFFFF ? "uint16" : max <= 0xFFFFFFFFll ? "uint32" : "uint64";
+        }
+
+        return min >= -0x80 && max <= 0x7F ? "int8"
+               : min >= -0x8000 && max <= 0x7FFF ? "int16"
+               : min >= -0x80000000ll && max <= 0x7FFFFFFFll ? "int32" : "int64";
+    }
+
+    // per instantiation, the observed range, what it would fit in, and the non-empty buckets of the histogram
+    inline void report (std::ostream& out) {
+        for (const Range_Profile& p : snapshot()) {
+            out << p.site << "\n";
+
+            if (p.values == 0) {
+                out << "    no values\n";
+                continue;
+            }
+
+            out << "    " << p.values << " values in [" << p.min << ", " << p.max << "]"
+                << ", fits " << smallest_type(p.min, p.max)
+                << ", or " << bit_length((unsigned long long) p.max - (unsigned long long) p.min) << " bits from " << p.min << "\n";
+
+            for (std::size_t b = 0; b < buckets; b++) {
+                if (p.histogram[b] != 0) {
+                    std::ostringstream range;
+                    range << "[" << bucket_low(b) << ", " << bucket_high(b) << "]";
+
+                    out << "    " << std::left << std::setw(48) << range.str() << std::right << std::setw(20) << p.histogram[b] << "\n";
+                }
+            }
+        }
+    }
+
+    CHECK_STATS_COLD
+    inline void report_at_exit () {
+        const char* path = std::getenv("RANGE_PROFILE_FILE");
+
+        if (path != nullptr && path[0] != '\0') {
+            std::ofstream file(path);
+            report(file);
+        } else {
+            report(std::cerr);
+        }
+    }
+
+    inline std::size_t register_site (const std::string& name) {
+#if RANGE_PROFILE_AT_EXIT
+        static const bool at_exit = std::atexit(report_at_exit) == 0;
+        (void) at_exit;
+#endif
+        return Profile_Registry::register_site(name);
+    }
+}
+
+// site is only evaluated when profiling, so may be a call that registers the instantiation on first use
+#define RANGE_PROFILE_RECORD(site, value)           (check_stats::counting() ? range_profile::record((site), (value)) : void())
+
+#else
+
+#define RANGE_PROFILE_RECORD(site, value)           ((void) 0)
+
+#endif // RANGE_PROFILE
+
+#endif // CHECK_STATS_H_INCLUDED
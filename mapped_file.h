@@ -0,0 +1,354 @@
+/* Read only memory mapped file, and bounds checked zero copy views of fixed layout records within it
+ * Exception MappedFileException is thrown when the file can not be opened or mapped
+ * Out of bound record access is handled as in Ranged_Ptr, and throws RangedPtrException by default
+ *
+ * License:
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+#include "ranged_ptr.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifndef MAPPED_FILE_H_INCLUDED
+#define MAPPED_FILE_H_INCLUDED
+
+class MappedFileException : public std::runtime_error {
+public:
+    MappedFileException (std::string errMsg) : runtime_error(errMsg) {}
+private:
+};
+
+namespace mapped_file_error {
+    // reason    File : path    Error : system error code
+    [[noreturn]] RANGE_TYPE_COLD
+    inline void raise (const char* reason, const char* path, long error_code) {
+        std::ostringstream error_message;
+
+        error_message << reason << "    File : " << path << "    Error : " << error_code;
+
+#if RANGE_TYPE_EXCEPTIONS
+        throw MappedFileException(error_message.str());
+#else
+        std::fputs(error_message.str().c_str(), stderr);
+        std::fputc('\n', stderr);
+        std::abort();
+#endif
+    }
+
+    // Record index out of bound
+    // Range : [ 0, count - 1 ]    Goal : index
+    [[noreturn]] RANGE_TYPE_COLD
+    inline void raise_out_of_bound (std::size_t count, std::size_t index) {
+        std::ostringstream error_message;
+
+        error_message << "Record index out of bound" << std::endl;
+        error_message << range_type_error::format<long long int>(0, (long long int) count - 1, Range_Status::overflow, 0,
+                                                                 (long long int) index, 0);
+        ranged_ptr_error::raise(error_message.str());
+    }
+}
+
+// Expected order of access, passed on to the kernel as a paging hint
+enum class Access_Pattern {
+    normal,
+    sequential,     // read ahead aggressively, pages behind may be dropped early
+    random          // no read ahead
+};
+
+// Whole file mapped read only, unmapped on destruction
+// An empty file gives data() == nullptr and size() == 0
+class Mapped_File {
+public:
+    Mapped_File () = delete;
+
+    explicit Mapped_File (const std::string& path, Access_Pattern pattern = Access_Pattern::normal) {
+        map(path.c_str());
+        advise(pattern);
+    }
+
+    Mapped_File (const Mapped_File&) = delete;
+
+    Mapped_File& operator= (const Mapped_File&) = delete;
+
+    Mapped_File (Mapped_File&& a) : map_data {a.map_data}, map_size {a.map_size} {
+        a.map_data = nullptr;
+        a.map_size = 0;
+    }
+
+    Mapped_File& operator= (Mapped_File&& a) {
+        if (this != &a) {
+            unmap();
+            this->map_data = a.map_data;
+            this->map_size = a.map_size;
+            a.map_data = nullptr;
+            a.map_size = 0;
+        }
+        return *this;
+    }
+
+    ~Mapped_File () {
+        unmap();
+    }
+
+    const unsigned char* data () const {
+        return this->map_data;
+    }
+
+    std::size_t size () const {
+        return this->map_size;
+    }
+
+    // checked pointer over the whole file, size() must be non-zero
+    Ranged_Buffer_Ptr<> ptr () const {
+        return Ranged_Buffer_Ptr<>(this->map_data, this->map_size);
+    }
+
+    // hints are best effort, failures are ignored
+    void advise (Access_Pattern pattern) const {
+#if !defined(_WIN32)
+        if (map_size == 0) {
+            return;
+        }
+
+        int advice;
+
+        switch (pattern) {
+            case Access_Pattern::sequential : advice = MADV_SEQUENTIAL; break;
+            case Access_Pattern::random     : advice = MADV_RANDOM;     break;
+            default                         : advice = MADV_NORMAL;     break;
+        }
+
+        madvise((void*) map_data, map_size, advice);
+#else
+        (void) pattern;
+#endif
+    }
+
+    // asks for [offset, offset + length) to be paged in ahead of use, clipped to the file
+    void prefetch (std::size_t offset, std::size_t length) const {
+        if (offset >= map_size) {
+            return;
+        }
+
+        if (length > map_size - offset) {
+            length = map_size - offset;
+        }
+
+#if defined(_WIN32)
+        WIN32_MEMORY_RANGE_ENTRY range;
+        range.VirtualAddress = (void*) (map_data + offset);
+        range.NumberOfBytes  = length;
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+        // madvise needs a page aligned start
+        std::size_t page  = (std::size_t) sysconf(_SC_PAGESIZE);
+        std::size_t start = offset - offset % page;
+
+        madvise((void*) (map_data + start), length + (offset - start), MADV_WILLNEED);
+#endif
+    }
+
+private:
+    const unsigned char* map_data = nullptr;
+    std::size_t map_size = 0;
+
+#if defined(_WIN32)
+    void map (const char* path) {
+        HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            mapped_file_error::raise("Failed to open file", path, (long) GetLastError());
+        }
+
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file, &file_size)) {
+            DWORD error = GetLastError();
+            CloseHandle(file);
+            mapped_file_error::raise("Failed to get file size", path, (long) error);
+        }
+
+        if (file_size.QuadPart == 0) {
+            CloseHandle(file);
+            return;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        DWORD error = GetLastError();
+        CloseHandle(file);
+        if (mapping == nullptr) {
+            mapped_file_error::raise("Failed to map file", path, (long) error);
+        }
+
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        error = GetLastError();
+        CloseHandle(mapping);
+        if (view == nullptr) {
+            mapped_file_error::raise("Failed to map file", path, (long) error);
+        }
+
+        this->map_data = (const unsigned char*) view;
+        this->map_size = (std::size_t) file_size.QuadPart;
+    }
+
+    void unmap () {
+        if (map_data != nullptr) {
+            UnmapViewOfFile(map_data);
+        }
+    }
+#else
+    void map (const char* path) {
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) {
+            mapped_file_error::raise("Failed to open file", path, errno);
+        }
+
+        struct stat file_stat;
+        if (fstat(fd, &file_stat) != 0) {
+            int error = errno;
+            close(fd);
+            mapped_file_error::raise("Failed to get file size", path, error);
+        }
+
+        if (file_stat.st_size == 0) {
+            close(fd);
+            return;
+        }
+
+        void* view = mmap(nullptr, (std::size_t) file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        int error = errno;
+        close(fd);
+        if (view == MAP_FAILED) {
+            mapped_file_error::raise("Failed to map file", path, error);
+        }
+
+        this->map_data = (const unsigned char*) view;
+        this->map_size = (std::size_t) file_stat.st_size;
+    }
+
+    void unmap () {
+        if (map_data != nullptr) {
+            munmap((void*) map_data, map_size);
+        }
+    }
+#endif
+};
+
+// Records of type T laid end to end, viewed in place without copying
+// Bytes after the last whole record are not part of the view
+// Policy is applied to the record index, see Range_Type, Status_On_Violation is not supported
+// The memory viewed must outlive the view, and is treated as read only
+template <typename T, typename Policy = Throw_On_Violation>
+class Record_View {
+
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Record type must be trivially copyable");
+
+    static_assert(!Policy::reports_status,
+                  "Record_View can not report status, policy must throw, saturate, wrap or trap");
+
+public:
+    Record_View () = delete;
+
+    // base must be aligned for T, which holds for the start of a mapping
+    Record_View (const void* base, std::size_t length) : records {(const T*) base}, record_count {length / sizeof(T)} {}
+
+    explicit Record_View (const Mapped_File& file) : Record_View(file.data(), file.size()) {}
+
+    // a temporary Mapped_File is unmapped at the end of the full expression, leaving the view dangling
+    Record_View (Mapped_File&&) = delete;
+
+    // checked, the record is not copied
+    const T& operator[] (std::size_t index) const {
+        return records[index_check(index)];
+    }
+
+    // byte level checked pointer confined to one record, for picking out fields with load
+    // read only, as is the mapping, so store and writes through * or [] do not compile
+    Ranged_Ptr<const T, Policy> record (std::size_t index) const {
+        return Ranged_Ptr<const T, Policy>(records[index_check(index)]);
+    }
+
+    std::size_t size () const {
+        return this->record_count;
+    }
+
+    bool empty () const {
+        return this->record_count == 0;
+    }
+
+    // range for over all records, each record is in bound by construction
+    const T* begin () const {
+        return records;
+    }
+
+    const T* end () const {
+        return records + record_count;
+    }
+
+private:
+    const T* records;
+    std::size_t record_count;
+
+    using throws = std::is_same<Policy, Throw_On_Violation>;
+
+    std::size_t index_check (std::size_t index) const {
+        if (RANGE_TYPE_UNLIKELY(index >= record_count)) {
+            return violation(index, throws());
+        }
+
+        return index;
+    }
+
+    std::size_t violation (std::size_t index, std::true_type) const {
+        mapped_file_error::raise_out_of_bound(record_count, index);
+    }
+
+    // the index can only be past the end, so the policy is handed an overflow of index + 0
+    std::size_t violation (std::size_t index, std::false_type) const {
+        if (RANGE_TYPE_UNLIKELY(record_count == 0)) {
+            mapped_file_error::raise_out_of_bound(record_count, index);
+        }
+
+        return Policy::template on_violation<std::size_t>(Range_Status::overflow, '+', index, 0, 0, record_count - 1);
+    }
+};
+
+#endif // MAPPED_FILE_H_INCLUDED
@@ -0,0 +1,551 @@
+/* Fixed size array of Mod_Type values with batch elementwise operations and reductions
+ * Results are identical to applying the Mod_Type operators element by element
+ *
+ * License:
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <type_traits>
+#include "mod_type.h"
+
+#ifndef MOD_ARRAY_H_INCLUDED
+#define MOD_ARRAY_H_INCLUDED
+
+// x86 vector kernels are compiled with per function target attributes and picked at runtime,
+// so no -mavx2/-mavx512f is needed
+// MOD_ARRAY_SIMD may be defined beforehand to cap the level used, 0 for scalar only, 1 for up to AVX2
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MOD_ARRAY_X86 1
+#include <immintrin.h>
+#else
+#define MOD_ARRAY_X86 0
+#endif
+
+#ifndef MOD_ARRAY_SIMD
+#define MOD_ARRAY_SIMD 2
+#endif
+
+enum class Mod_Simd_Level {
+    scalar = 0,
+    avx2   = 1,
+    avx512 = 2
+};
+
+// best instruction set available on the running machine, detected once
+inline Mod_Simd_Level mod_simd_level () {
+#if MOD_ARRAY_X86
+    static const Mod_Simd_Level level = [] {
+        __builtin_cpu_init();
+        if (MOD_ARRAY_SIMD >= 2 && __builtin_cpu_supports("avx512f")) {
+            return Mod_Simd_Level::avx512;
+        }
+        if (MOD_ARRAY_SIMD >= 1 && __builtin_cpu_supports("avx2")) {
+            return Mod_Simd_Level::avx2;
+        }
+        return Mod_Simd_Level::scalar;
+    }();
+
+    return level;
+#else
+    return Mod_Simd_Level::scalar;
+#endif
+}
+
+// Batch operations on contiguous values of Mod_Type<T, UB>, all inputs must already be in [0, UB)
+// out may alias a or b
+//
+// Vector kernels cover 32 bit T with 2 <= UB <= 2^31, which keeps every sum inside 32 bits
+// Multiplication uses Barrett reduction on 32 x 32 -> 64 bit lanes,
+// with n = bit length of UB and m = floor(2^2n / UB)
+// Everything else runs the scalar loop
+template <typename T, long long int UB>
+class Mod_Batch {
+
+    using mod_type   = Mod_Type<T, UB>;
+    using unsigned_T = typename std::make_unsigned<T>::type;
+
+public:
+    static void add (const T* a, const T* b, T* out, std::size_t n) {
+        std::size_t i = 0;
+
+#if MOD_ARRAY_X86
+        if (vectorised) {
+            switch (mod_simd_level()) {
+                case Mod_Simd_Level::avx512 : i = add_avx512(a, b, out, n); break;
+                case Mod_Simd_Level::avx2   : i = add_avx2(a, b, out, n);   break;
+                default                     :                               break;
+            }
+        }
+#endif
+
+        for (; i < n; i++) {
+            out[i] = mod_type::mod_add_reduced(a[i], b[i]);
+        }
+    }
+
+    static void sub (const T* a, const T* b, T* out, std::size_t n) {
+        std::size_t i = 0;
+
+#if MOD_ARRAY_X86
+        if (vectorised) {
+            switch (mod_simd_level()) {
+                case Mod_Simd_Level::avx512 : i = sub_avx512(a, b, out, n); break;
+                case Mod_Simd_Level::avx2   : i = sub_avx2(a, b, out, n);   break;
+                default                     :                               break;
+            }
+        }
+#endif
+
+        for (; i < n; i++) {
+            out[i] = mod_type::mod_sub_reduced(a[i], b[i]);
+        }
+    }
+
+    static void mul (const T* a, const T* b, T* out, std::size_t n) {
+        std::size_t i = 0;
+
+#if MOD_ARRAY_X86
+        if (vectorised) {
+            switch (mod_simd_level()) {
+                case Mod_Simd_Level::avx512 : i = mul_avx512(a, b, out, n); break;
+                case Mod_Simd_Level::avx2   : i = mul_avx2(a, b, out, n);   break;
+                default                     :                               break;
+            }
+        }
+#endif
+
+        for (; i < n; i++) {
+            out[i] = mod_type::mod_mul_reduced(a[i], b[i]);
+        }
+    }
+
+    static mod_type sum (const T* a, std::size_t n) {
+        mod_type acc;
+        std::size_t i = 0;
+
+#if MOD_ARRAY_X86
+        if (vectorised) {
+            switch (mod_simd_level()) {
+                case Mod_Simd_Level::avx512 : i = sum_avx512(a, n, acc); break;
+                case Mod_Simd_Level::avx2   : i = sum_avx2(a, n, acc);   break;
+                default                     :                            break;
+            }
+        }
+#endif
+
+        for (; i < n; i++) {
+            acc += mod_type::reduced(a[i]);
+        }
+
+        return acc;
+    }
+
+    static mod_type dot (const T* a, const T* b, std::size_t n) {
+        mod_type acc;
+        T products[block];
+
+        // products are reduced a block at a time, then summed
+        for (std::size_t i = 0; i < n; i += block) {
+            std::size_t len = n - i < block ? n - i : block;
+
+            mul(a + i, b + i, products, len);
+            acc += sum(products, len);
+        }
+
+        return acc;
+    }
+
+    // out[i] = a[i].inverse() by Montgomery's trick, the product of a block of values is inverted once
+    // and each inverse is recovered from it and the prefix products with 3 multiplications
+    // throws ModTypeException when some a[i] has no inverse, leaving out partly written
+    static void inverse (const T* a, T* out, std::size_t n) {
+        T prefix[block];
+
+        for (std::size_t i = 0; i < n; i += block) {
+            std::size_t len = n - i < block ? n - i : block;
+
+            // prefix[k] = a[i] * a[i + 1] * ... * a[i + k]
+            prefix[0] = a[i];
+            for (std::size_t k = 1; k < len; k++) {
+                prefix[k] = mod_type::mod_mul_reduced(prefix[k - 1], a[i + k]);
+            }
+
+            // inverse of prefix[k], walking back one value at a time
+            T inv = mod_type::mod_inv_reduced(prefix[len - 1]);
+
+            for (std::size_t k = len - 1; k > 0; k--) {
+                T next = mod_type::mod_mul_reduced(inv, a[i + k]);   // read before out[i + k] may overwrite it
+                out[i + k] = mod_type::mod_mul_reduced(inv, prefix[k - 1]);
+                inv = next;
+            }
+
+            out[i] = inv;
+        }
+    }
+
+private:
+    static const unsigned_T modulus = unsigned_T(UB);
+    static const std::size_t block = 256;
+
+    static const bool vectorised = sizeof(T) == 4 && UB >= 2 && UB <= (1LL << 31);
+
+    // Barrett parameters for the vector multiply, only meaningful when vectorised
+    static constexpr int bit_length (unsigned long long x, int n = 0) {
+        return x == 0 ? n : bit_length(x >> 1, n + 1);
+    }
+
+    static const int bits = bit_length((unsigned long long) UB - 1);
+    static const unsigned long long barrett_m = vectorised ? (1ULL << (2 * bits)) / (unsigned long long) UB : 0;
+
+    // running sums are folded back below UB before 64 bit lanes could overflow
+    static const std::size_t sum_fold = std::size_t(1) << 30;
+
+#if MOD_ARRAY_X86
+// GCC reports the _mm512_undefined_epi32 placeholder inside the AVX-512 intrinsics as uninitialised
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+    __attribute__((target("avx2")))
+    static __m256i add_mod_avx2 (__m256i a, __m256i b) {
+        const __m256i m = _mm256_set1_epi32(int(modulus));
+        __m256i s = _mm256_add_epi32(a, b);
+
+        // s < 2 * UB <= 2^32, s - UB wraps around to a larger value exactly when s < UB
+        return _mm256_min_epu32(s, _mm256_sub_epi32(s, m));
+    }
+
+    __attribute__((target("avx2")))
+    static __m256i sub_mod_avx2 (__m256i a, __m256i b) {
+        const __m256i m = _mm256_set1_epi32(int(modulus));
+        __m256i d = _mm256_sub_epi32(a, b);
+
+        return _mm256_min_epu32(d, _mm256_add_epi32(d, m));
+    }
+
+    // a * b mod UB for the low 32 bits of each 64 bit lane, result in the low 32 bits
+    __attribute__((target("avx2")))
+    static __m256i mul_mod_avx2_even (__m256i a, __m256i b) {
+        const __m256i m     = _mm256_set1_epi64x((long long) modulus);
+        const __m256i mu    = _mm256_set1_epi64x((long long) barrett_m);
+        const __m128i shift_low  = _mm_cvtsi32_si128(bits - 1);
+        const __m128i shift_high = _mm_cvtsi32_si128(bits + 1);
+
+        __m256i x = _mm256_mul_epu32(a, b);
+        __m256i q = _mm256_srl_epi64(_mm256_mul_epu32(_mm256_srl_epi64(x, shift_low), mu), shift_high);
+        __m256i r = _mm256_sub_epi64(x, _mm256_mul_epu32(q, m));
+
+        // estimated quotient is at most 2 below the real one
+        r = _mm256_sub_epi64(r, _mm256_andnot_si256(_mm256_cmpgt_epi64(m, r), m));
+        r = _mm256_sub_epi64(r, _mm256_andnot_si256(_mm256_cmpgt_epi64(m, r), m));
+
+        return r;
+    }
+
+    __attribute__((target("avx2")))
+    static __m256i mul_mod_avx2 (__m256i a, __m256i b) {
+        __m256i even = mul_mod_avx2_even(a, b);
+        __m256i odd  = mul_mod_avx2_even(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+
+        return _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+    }
+
+    __attribute__((target("avx2")))
+    static std::size_t add_avx2 (const T* a, const T* b, T* out, std::size_t n) {
+        std::size_t i = 0;
+
+        for (; i + 8 <= n; i += 8) {
+            __m256i va = _mm256_loadu_si256((const __m256i*) (a + i));
+            __m256i vb = _mm256_loadu_si256((const __m256i*) (b + i));
+            _mm256_storeu_si256((__m256i*) (out + i), add_mod_avx2(va, vb));
+        }
+
+        return i;
+    }
+
+    __attribute__((target("avx2")))
+    static std::size_t sub_avx2 (const T* a, const T* b, T* out, std::size_t n) {
+        std::size_t i = 0;
+
+        for (; i + 8 <= n; i += 8) {
+            __m256i va = _mm256_loadu_si256((const __m256i*) (a + i));
+            __m256i vb = _mm256_loadu_si256((const __m256i*) (b + i));
+            _mm256_storeu_si256((__m256i*) (out + i), sub_mod_avx2(va, vb));
+        }
+
+        return i;
+    }
+
+    __attribute__((target("avx2")))
+    static std::size_t mul_avx2 (const T* a, const T* b, T* out, std::size_t n) {
+        std::size_t i = 0;
+
+        for (; i + 8 <= n; i += 8) {
+            __m256i va = _mm256_loadu_si256((const __m256i*) (a + i));
+            __m256i vb = _mm256_loadu_si256((const __m256i*) (b + i));
+            _mm256_storeu_si256((__m256i*) (out + i), mul_mod_avx2(va, vb));
+        }
+
+        return i;
+    }
+
+    __attribute__((target("avx2")))
+    static std::size_t sum_avx2 (const T* a, std::size_t n, mod_type& acc) {
+        std::size_t i = 0;
+
+        while (i + 8 <= n) {
+            __m256i lanes = _mm256_setzero_si256();
+            std::size_t end = n - i > sum_fold ? i + sum_fold : n;
+
+            // values are below 2^31, so 2^30 of them per 64 bit lane cannot overflow
+            for (; i + 8 <= end; i += 8) {
+                __m256i v = _mm256_loadu_si256((const __m256i*) (a + i));
+                lanes = _mm256_add_epi64(lanes, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(v)));
+                lanes = _mm256_add_epi64(lanes, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(v, 1)));
+            }
+
+            alignas(32) unsigned long long parts[4];
+            _mm256_store_si256((__m256i*) parts, lanes);
+            for (int k = 0; k < 4; k++) {
+                acc += mod_type::reduced(T(parts[k] % modulus));
+            }
+        }
+
+        return i;
+    }
+
+    __attribute__((target("avx512f")))
+    static __m512i add_mod_avx512 (__m512i a, __m512i b) {
+        const __m512i m = _mm512_set1_epi32(int(modulus));
+        __m512i s = _mm512_add_epi32(a, b);
+
+        return _mm512_min_epu32(s, _mm512_sub_epi32(s, m));
+    }
+
+    __attribute__((target("avx512f")))
+    static __m512i sub_mod_avx512 (__m512i a, __m512i b) {
+        const __m512i m = _mm512_set1_epi32(int(modulus));
+        __m512i d = _mm512_sub_epi32(a, b);
+
+        return _mm512_min_epu32(d, _mm512_add_epi32(d, m));
+    }
+
+    __attribute__((target("avx512f")))
+    static __m512i mul_mod_avx512_even (__m512i a, __m512i b) {
+        const __m512i m     = _mm512_set1_epi64((long long) modulus);
+        const __m512i mu    = _mm512_set1_epi64((long long) barrett_m);
+        const __m128i shift_low  = _mm_cvtsi32_si128(bits - 1);
+        const __m128i shift_high = _mm_cvtsi32_si128(bits + 1);
+
+        __m512i x = _mm512_mul_epu32(a, b);
+        __m512i q = _mm512_srl_epi64(_mm512_mul_epu32(_mm512_srl_epi64(x, shift_low), mu), shift_high);
+        __m512i r = _mm512_sub_epi64(x, _mm512_mul_epu32(q, m));
+
+        r = _mm512_mask_sub_epi64(r, _mm512_cmpge_epu64_mask(r, m), r, m);
+        r = _mm512_mask_sub_epi64(r, _mm512_cmpge_epu64_mask(r, m), r, m);
+
+        return r;
+    }
+
+    __attribute__((target("avx512f")))
+    static __m512i mul_mod_avx512 (__m512i a, __m512i b) {
+        __m512i even = mul_mod_avx512_even(a, b);
+        __m512i odd  = mul_mod_avx512_even(_mm512_srli_epi64(a, 32), _mm512_srli_epi64(b, 32));
+
+        return _mm512_mask_blend_epi32(0xAAAA, even, _mm512_slli_epi64(odd, 32));
+    }
+
+    __attribute__((target("avx512f")))
+    static std::size_t add_avx512 (const T* a, const T* b, T* out, std::size_t n) {
+        std::size_t i = 0;
+
+        for (; i + 16 <= n; i += 16) {
+            __m512i va = _mm512_loadu_si512((const void*) (a + i));
+            __m512i vb = _mm512_loadu_si512((const void*) (b + i));
+            _mm512_storeu_si512((void*) (out + i), add_mod_avx512(va, vb));
+        }
+
+        return i;
+    }
+
+    __attribute__((target("avx512f")))
+    static std::size_t sub_avx512 (const T* a, const T* b, T* out, std::size_t n) {
+        std::size_t i = 0;
+
+        for (; i + 16 <= n; i += 16) {
+            __m512i va = _mm512_loadu_si512((const void*) (a + i));
+            __m512i vb = _mm512_loadu_si512((const void*) (b + i));
+            _mm512_storeu_si512((void*) (out + i), sub_mod_avx512(va, vb));
+        }
+
+        return i;
+    }
+
+    __attribute__((target("avx512f")))
+    static std::size_t mul_avx512 (const T* a, const T* b, T* out, std::size_t n) {
+        std::size_t i = 0;
+
+        for (; i + 16 <= n; i += 16) {
+            __m512i va = _mm512_loadu_si512((const void*) (a + i));
+            __m512i vb = _mm512_loadu_si512((const void*) (b + i));
+            _mm512_storeu_si512((void*) (out + i), mul_mod_avx512(va, vb));
+        }
+
+        return i;
+    }
+
+    __attribute__((target("avx512f")))
+    static std::size_t sum_avx512 (const T* a, std::size_t n, mod_type& acc) {
+        std::size_t i = 0;
+
+        while (i + 16 <= n) {
+            __m512i lanes = _mm512_setzero_si512();
+            std::size_t end = n - i > sum_fold ? i + sum_fold : n;
+
+            for (; i + 16 <= end; i += 16) {
+                __m512i v = _mm512_loadu_si512((const void*) (a + i));
+                lanes = _mm512_add_epi64(lanes, _mm512_cvtepu32_epi64(_mm512_castsi512_si256(v)));
+                lanes = _mm512_add_epi64(lanes, _mm512_cvtepu32_epi64(_mm512_extracti64x4_epi64(v, 1)));
+            }
+
+            alignas(64) unsigned long long parts[8];
+            _mm512_store_si512((void*) parts, lanes);
+            for (int k = 0; k < 8; k++) {
+                acc += mod_type::reduced(T(parts[k] % modulus));
+            }
+        }
+
+        return i;
+    }
+
+#pragma GCC diagnostic pop
+#endif
+};
+
+template <typename T, long long int UB, std::size_t N>
+class Mod_Array {
+public:
+    using value_type = Mod_Type<T, UB>;
+
+    // all elements initialised to 0
+    Mod_Array () : vals {} {}
+
+    value_type operator[] (std::size_t i) const {
+        return value_type::reduced(vals[i]);
+    }
+
+    void set (std::size_t i, const value_type& a) {
+        vals[i] = a.value();
+    }
+
+    // underlying values, each in [0, UB)
+    const T* data () const {
+        return vals;
+    }
+
+    std::size_t size () const {
+        return N;
+    }
+
+    friend Mod_Array operator+ (const Mod_Array& a, const Mod_Array& b) {
+        Mod_Array result;
+        batch::add(a.vals, b.vals, result.vals, N);
+        return result;
+    }
+
+    friend Mod_Array operator- (const Mod_Array& a, const Mod_Array& b) {
+        Mod_Array result;
+        batch::sub(a.vals, b.vals, result.vals, N);
+        return result;
+    }
+
+    friend Mod_Array operator* (const Mod_Array& a, const Mod_Array& b) {
+        Mod_Array result;
+        batch::mul(a.vals, b.vals, result.vals, N);
+        return result;
+    }
+
+    Mod_Array& operator+= (const Mod_Array& a) {
+        batch::add(this->vals, a.vals, this->vals, N);
+        return *this;
+    }
+
+    Mod_Array& operator-= (const Mod_Array& a) {
+        batch::sub(this->vals, a.vals, this->vals, N);
+        return *this;
+    }
+
+    Mod_Array& operator*= (const Mod_Array& a) {
+        batch::mul(this->vals, a.vals, this->vals, N);
+        return *this;
+    }
+
+    friend bool operator== (const Mod_Array& a, const Mod_Array& b) {
+        for (std::size_t i = 0; i < N; i++) {
+            if (a.vals[i] != b.vals[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    friend bool operator!= (const Mod_Array& a, const Mod_Array& b) {
+        return !(a == b);
+    }
+
+    value_type sum () const {
+        return batch::sum(vals, N);
+    }
+
+    // elementwise inverse, throws ModTypeException when some element has none
+    Mod_Array inverse () const {
+        Mod_Array result;
+        batch::inverse(this->vals, result.vals, N);
+        return result;
+    }
+
+    friend value_type dot (const Mod_Array& a, const Mod_Array& b) {
+        return batch::dot(a.vals, b.vals, N);
+    }
+
+    friend std::ostream& operator<< (std::ostream& out, const Mod_Array& a) {
+        out << "[";
+        for (std::size_t i = 0; i < N; i++) {
+            out << (i == 0 ? " " : ", ") << +a.vals[i];
+        }
+        out << " ]";
+        return out;
+    }
+
+private:
+    using batch = Mod_Batch<T, UB>;
+
+    alignas(64) T vals[N];
+};
+
+#endif // MOD_ARRAY_H_INCLUDED
@@ -0,0 +1,386 @@
+/* Dense matrices of Mod_Type values, with a cache blocked and optionally multithreaded multiplication
+ * Results are identical to multiplying out with the Mod_Type operators, but products are summed
+ * in a wider accumulator and only reduced when it could overflow, not on every multiply-add
+ *
+ * License:
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <ostream>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "mod_array.h"
+#include "mod_type.h"
+
+#ifndef MOD_MATRIX_H_INCLUDED
+#define MOD_MATRIX_H_INCLUDED
+
+// Sums of products of values in [0, UB), kept unreduced for as long as the accumulator allows
+namespace mod_matrix_arith {
+    enum class Lazy_Kind {
+        wrap,       // power of two UB, sums wrap around 2^64 and are masked at the end
+        wide_64,    // UB <= 2^32, products fit in 64 bits
+        wide_128,   // larger UB, products fit in 128 bits
+        direct      // larger UB without a 128 bit type, every product is reduced
+    };
+
+    template <long long int UB>
+    constexpr Lazy_Kind lazy_kind () {
+        return mod_type_arith::is_power_of_two<(unsigned long long) UB>::value ? Lazy_Kind::wrap
+             : (unsigned long long) UB <= (1ULL << 32)                         ? Lazy_Kind::wide_64
+             : MOD_TYPE_INT128                                                  ? Lazy_Kind::wide_128
+             :                                                                    Lazy_Kind::direct;
+    }
+
+    // acc       : accumulator type
+    // lazy      : number of products that may be added to a reduced accumulator before it has to be reduced again
+    // add       : acc += a * b
+    // reduce    : acc mod UB
+    template <typename T, long long int UB, Lazy_Kind K = lazy_kind<UB>()>
+    struct Lazy_Sum;
+
+    template <typename T, long long int UB>
+    struct Lazy_Sum<T, UB, Lazy_Kind::wrap> {
+        using acc = unsigned long long;
+
+        static const unsigned long long lazy = std::numeric_limits<unsigned long long>::max();
+
+        static void add (acc& s, acc a, T b) {
+            s += a * (unsigned long long) b;
+        }
+
+        static T reduce (acc s) {
+            return T(s & (unsigned long long) (UB - 1));
+        }
+    };
+
+    template <typename T, long long int UB>
+    struct Lazy_Sum<T, UB, Lazy_Kind::wide_64> {
+        using acc = unsigned long long;
+
+        static const unsigned long long max_product = (unsigned long long) (UB - 1) * (unsigned long long) (UB - 1);
+        static const unsigned long long lazy = (std::numeric_limits<unsigned long long>::max() - (UB - 1)) / max_product;
+
+        static void add (acc& s, acc a, T b) {
+            s += a * (unsigned long long) b;
+        }
+
+        static T reduce (acc s) {
+            return T(mod_type_arith::Barrett<unsigned long long, (unsigned long long) UB>::reduce(s));
+        }
+    };
+
+#if MOD_TYPE_INT128
+    template <typename T, long long int UB>
+    struct Lazy_Sum<T, UB, Lazy_Kind::wide_128> {
+        using acc = unsigned __int128;
+
+        static constexpr unsigned __int128 max_product = (unsigned __int128) (UB - 1) * (unsigned __int128) (UB - 1);
+        static constexpr unsigned __int128 room = (~(unsigned __int128) 0 - (unsigned __int128) (UB - 1)) / max_product;
+        static const unsigned long long lazy =
+            room > std::numeric_limits<unsigned long long>::max() ? std::numeric_limits<unsigned long long>::max()
+                                                                  : (unsigned long long) room;
+
+        static void add (acc& s, acc a, T b) {
+            s += a * (unsigned __int128) b;
+        }
+
+        static T reduce (acc s) {
+            return T(s % (unsigned __int128) UB);
+        }
+    };
+#endif
+
+    template <typename T, long long int UB>
+    struct Lazy_Sum<T, UB, Lazy_Kind::direct> {
+        using acc = Mod_Type<T, UB>;
+
+        static const unsigned long long lazy = std::numeric_limits<unsigned long long>::max();
+
+        static void add (acc& s, const acc& a, T b) {
+            s += a * b;
+        }
+
+        static T reduce (const acc& s) {
+            return s.value();
+        }
+    };
+}
+
+// rows x cols matrix of Mod_Type<T, UB>, stored row major, all elements in [0, UB)
+//
+// Multiplication works on tiles of row_block x col_block elements of the result, held in wide accumulators,
+// walking the shared dimension a slice of depth_block at a time, so that the slice of the right hand matrix
+// stays in cache while every row of the tile uses it, and the innermost loop runs along contiguous rows
+// Accumulators are only reduced when adding another slice could overflow them, and once at the end
+// Tiles of rows are shared out between threads
+template <typename T, long long int UB>
+class Mod_Matrix {
+public:
+    using value_type = Mod_Type<T, UB>;
+
+    // all elements initialised to 0
+    Mod_Matrix (std::size_t rows, std::size_t cols) : n_rows {rows}, n_cols {cols}, vals(rows * cols) {}
+
+    static Mod_Matrix identity (std::size_t n) {
+        Mod_Matrix result(n, n);
+        for (std::size_t i = 0; i < n; i++) {
+            result.vals[i * n + i] = value_type(T(1)).value();
+        }
+        return result;
+    }
+
+    std::size_t rows () const {
+        return this->n_rows;
+    }
+
+    std::size_t cols () const {
+        return this->n_cols;
+    }
+
+    value_type operator() (std::size_t i, std::size_t j) const {
+        return value_type::reduced(vals[i * n_cols + j]);
+    }
+
+    void set (std::size_t i, std::size_t j, const value_type& a) {
+        vals[i * n_cols + j] = a.value();
+    }
+
+    // underlying values, row major, each in [0, UB)
+    const T* data () const {
+        return vals.data();
+    }
+
+    // all of the following throw ModTypeException when the dimensions do not match
+    friend Mod_Matrix operator+ (const Mod_Matrix& a, const Mod_Matrix& b) {
+        check_same_shape(a, b);
+        Mod_Matrix result(a.n_rows, a.n_cols);
+        batch::add(a.vals.data(), b.vals.data(), result.vals.data(), a.vals.size());
+        return result;
+    }
+
+    friend Mod_Matrix operator- (const Mod_Matrix& a, const Mod_Matrix& b) {
+        check_same_shape(a, b);
+        Mod_Matrix result(a.n_rows, a.n_cols);
+        batch::sub(a.vals.data(), b.vals.data(), result.vals.data(), a.vals.size());
+        return result;
+    }
+
+    // threads are only used when the product is large enough to pay for starting them
+    friend Mod_Matrix operator* (const Mod_Matrix& a, const Mod_Matrix& b) {
+        unsigned threads = double(a.n_rows) * double(a.n_cols) * double(b.n_cols) < double(parallel_work)
+                           ? 1
+                           : std::thread::hardware_concurrency();
+        return multiply(a, b, threads);
+    }
+
+    Mod_Matrix& operator+= (const Mod_Matrix& a) {
+        check_same_shape(*this, a);
+        batch::add(this->vals.data(), a.vals.data(), this->vals.data(), this->vals.size());
+        return *this;
+    }
+
+    Mod_Matrix& operator-= (const Mod_Matrix& a) {
+        check_same_shape(*this, a);
+        batch::sub(this->vals.data(), a.vals.data(), this->vals.data(), this->vals.size());
+        return *this;
+    }
+
+    Mod_Matrix& operator*= (const Mod_Matrix& a) {
+        *this = *this * a;
+        return *this;
+    }
+
+    // a * b on the given number of threads, 0 meaning one per hardware thread
+    static Mod_Matrix multiply (const Mod_Matrix& a, const Mod_Matrix& b, unsigned threads) {
+        if (a.n_cols != b.n_rows) {
+            mod_type_arith::raise("Matrix dimensions do not match");
+        }
+
+        Mod_Matrix result(a.n_rows, b.n_cols);
+
+        std::size_t tiles = (a.n_rows + row_block - 1) / row_block;
+
+        if (threads == 0) {
+            threads = std::thread::hardware_concurrency();
+        }
+        if (threads > tiles) {
+            threads = unsigned(tiles);
+        }
+
+        if (threads <= 1) {
+            multiply_tiles(a, b, result, 0, 1);
+            return result;
+        }
+
+        // thread t takes tiles t, t + threads, t + 2 * threads, ... and the calling thread takes tiles 0, threads, ...
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < threads; t++) {
+            workers.emplace_back(multiply_tiles, std::cref(a), std::cref(b), std::ref(result), std::size_t(t), std::size_t(threads));
+        }
+
+        multiply_tiles(a, b, result, 0, threads);
+
+        for (auto& w : workers) {
+            w.join();
+        }
+
+        return result;
+    }
+
+    // this^e by square and multiply, for square matrices, this^0 being the identity
+    Mod_Matrix pow (unsigned long long e) const {
+        if (n_rows != n_cols) {
+            mod_type_arith::raise("Matrix dimensions do not match");
+        }
+
+        Mod_Matrix acc  = identity(n_rows);
+        Mod_Matrix base = *this;
+
+        while (e != 0) {
+            if ((e & 1) != 0) {
+                acc = acc * base;
+            }
+
+            e >>= 1;
+
+            if (e != 0) {
+                base = base * base;
+            }
+        }
+
+        return acc;
+    }
+
+    friend bool operator== (const Mod_Matrix& a, const Mod_Matrix& b) {
+        return a.n_rows == b.n_rows && a.n_cols == b.n_cols && a.vals == b.vals;
+    }
+
+    friend bool operator!= (const Mod_Matrix& a, const Mod_Matrix& b) {
+        return !(a == b);
+    }
+
+    friend std::ostream& operator<< (std::ostream& out, const Mod_Matrix& a) {
+        out << "[";
+        for (std::size_t i = 0; i < a.n_rows; i++) {
+            out << (i == 0 ? " [" : ", [");
+            for (std::size_t j = 0; j < a.n_cols; j++) {
+                out << (j == 0 ? " " : ", ") << +a.vals[i * a.n_cols + j];
+            }
+            out << " ]";
+        }
+        out << " ]";
+        return out;
+    }
+
+private:
+    using batch     = Mod_Batch<T, UB>;
+    using lazy_sum  = mod_matrix_arith::Lazy_Sum<T, UB>;
+    using acc_type  = typename lazy_sum::acc;
+
+    // the accumulator tile is row_block x col_block, at most 16 KiB with 64 bit accumulators
+    static const std::size_t row_block   = 16;
+    static const std::size_t col_block   = 128;
+    static const std::size_t depth_block = 256;
+
+    // multiply-adds below which a product stays on the calling thread
+    static const unsigned long long parallel_work = 1ULL << 22;
+
+    std::size_t n_rows;
+    std::size_t n_cols;
+    std::vector<T> vals;
+
+    static void check_same_shape (const Mod_Matrix& a, const Mod_Matrix& b) {
+        if (a.n_rows != b.n_rows || a.n_cols != b.n_cols) {
+            mod_type_arith::raise("Matrix dimensions do not match");
+        }
+    }
+
+    // tiles of rows first, first + step, first + 2 * step, ... of out = a * b
+    static void multiply_tiles (const Mod_Matrix& a, const Mod_Matrix& b, Mod_Matrix& out, std::size_t first, std::size_t step) {
+        const std::size_t n = a.n_rows;
+        const std::size_t k = a.n_cols;
+        const std::size_t m = b.n_cols;
+
+        // slices of the shared dimension, never more products than an accumulator can take
+        const std::size_t slice = lazy_sum::lazy < depth_block ? std::size_t(lazy_sum::lazy) : depth_block;
+
+        std::vector<acc_type> acc(row_block * col_block);
+
+        for (std::size_t i0 = first * row_block; i0 < n; i0 += step * row_block) {
+            std::size_t i1 = std::min(i0 + row_block, n);
+
+            for (std::size_t j0 = 0; j0 < m; j0 += col_block) {
+                std::size_t width = std::min(j0 + col_block, m) - j0;
+                unsigned long long pending = 0;     // products added since the tile was last reduced
+
+                std::fill(acc.begin(), acc.end(), acc_type(0));
+
+                for (std::size_t p0 = 0; p0 < k; p0 += slice) {
+                    std::size_t p1 = std::min(p0 + slice, k);
+
+                    for (std::size_t i = i0; i < i1; i++) {
+                        acc_type* row = &acc[(i - i0) * col_block];
+
+                        for (std::size_t p = p0; p < p1; p++) {
+                            const acc_type x = acc_type(a.vals[i * k + p]);
+                            const T* b_row   = &b.vals[p * m + j0];
+
+                            for (std::size_t j = 0; j < width; j++) {
+                                lazy_sum::add(row[j], x, b_row[j]);
+                            }
+                        }
+                    }
+
+                    pending += p1 - p0;
+
+                    // another slice might not fit, so bring every accumulator of the tile back below UB
+                    if (p1 < k && lazy_sum::lazy - pending < slice) {
+                        for (std::size_t i = 0; i < i1 - i0; i++) {
+                            for (std::size_t j = 0; j < width; j++) {
+                                acc[i * col_block + j] = acc_type(lazy_sum::reduce(acc[i * col_block + j]));
+                            }
+                        }
+                        pending = 0;
+                    }
+                }
+
+                for (std::size_t i = i0; i < i1; i++) {
+                    for (std::size_t j = 0; j < width; j++) {
+                        out.vals[i * m + j0 + j] = lazy_sum::reduce(acc[(i - i0) * col_block + j]);
+                    }
+                }
+            }
+        }
+    }
+};
+
+#endif // MOD_MATRIX_H_INCLUDED
@@ -0,0 +1,334 @@
+/* Number theoretic transform over Mod_Type, for convolution and polynomial multiplication modulo a prime
+ * Transforms are iterative and in place, with radix-4 butterflies and twiddle tables computed once per engine
+ * Convolution of lengths n and m takes O((n + m) log(n + m)) instead of O(n * m)
+ *
+ * License:
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "mod_type.h"
+
+#ifndef MOD_NTT_H_INCLUDED
+#define MOD_NTT_H_INCLUDED
+
+// Transforms of power of two sizes up to max_size over Mod_Type<T, UB>, UB being a prime
+// A size n transform needs a root of unity of order n, so n must divide UB - 1,
+// 998244353 = 119 * 2^23 + 1 for example allows sizes up to 2^23
+//
+// Forward transforms run decimation in frequency, natural order in and bit reversed order out,
+// inverse transforms run decimation in time, bit reversed order in and natural order out
+// Two radix-2 stages are merged into one radix-4 pass, halving the passes over the data,
+// with a single radix-2 pass left over when log2(n) is odd
+// convolve() pairs the two directly, so no bit reversal is done there
+template <typename T, long long int UB>
+class Mod_Ntt {
+
+    static_assert(UB > 2 && UB % 2 == 1,
+                  "Upper bound is not an odd prime");
+
+public:
+    using value_type = Mod_Type<T, UB>;
+
+    // throws ModTypeException when max_size is not a power of two dividing UB - 1
+    explicit Mod_Ntt (std::size_t max_size)
+        : max_n {checked_max_size(max_size)}, roots(max_n), roots3(max_n), inv_roots(max_n), inv_roots3(max_n) {
+
+        value_type w = root_of_unity(max_size);
+
+        fill(roots, roots3, w);
+        fill(inv_roots, inv_roots3, w.inverse());
+    }
+
+    std::size_t max_size () const {
+        return this->max_n;
+    }
+
+    // largest power of two dividing UB - 1
+    static constexpr std::size_t size_limit () {
+        return size_limit_of((unsigned long long) UB - 1);
+    }
+
+    // a[k] = sum of a[i] * w^(i * k), w a root of unity of order n, n a power of two up to max_size()
+    void transform (value_type* a, std::size_t n) const {
+        check_size(n);
+        dif(a, n);
+        bit_reverse(a, n);
+    }
+
+    // undoes transform(), including the division by n
+    void inverse_transform (value_type* a, std::size_t n) const {
+        check_size(n);
+        bit_reverse(a, n);
+        dit(a, n);
+        scale(a, n);
+    }
+
+    void transform (std::vector<value_type>& a) const {
+        transform(a.data(), a.size());
+    }
+
+    void inverse_transform (std::vector<value_type>& a) const {
+        inverse_transform(a.data(), a.size());
+    }
+
+    // c[k] = sum of a[i] * b[k - i], of length a.size() + b.size() - 1,
+    // that is the coefficients of the product of the polynomials with coefficients a and b
+    // short inputs are multiplied out directly, where that is faster than transforming
+    std::vector<value_type> convolve (const std::vector<value_type>& a, const std::vector<value_type>& b) const {
+        if (a.empty() || b.empty()) {
+            return std::vector<value_type>();
+        }
+
+        std::size_t len = a.size() + b.size() - 1;
+
+        if (a.size() <= direct_limit || b.size() <= direct_limit) {
+            return convolve_direct(a, b);
+        }
+
+        std::size_t n = 1;
+        while (n < len) {
+            n *= 2;
+        }
+        check_size(n);
+
+        std::vector<value_type> fa(n), fb(n);
+        std::copy(a.begin(), a.end(), fa.begin());
+        std::copy(b.begin(), b.end(), fb.begin());
+
+        dif(fa.data(), n);
+        dif(fb.data(), n);
+
+        // pointwise product, in the same bit reversed order for both, with the division by n folded in
+        T n_inv = value_type::mod_inv_reduced(T(n));
+
+        for (std::size_t i = 0; i < n; i++) {
+            fa[i].val = value_type::mod_mul_reduced(value_type::mod_mul_reduced(fa[i].val, fb[i].val), n_inv);
+        }
+
+        dit(fa.data(), n);
+        fa.resize(len);
+
+        return fa;
+    }
+
+private:
+    // below this many values on either side, the O(n * m) loop beats three transforms
+    static const std::size_t direct_limit = 32;
+
+    std::size_t max_n;
+
+    // table[len / 2 + j]  = w_len^j      for j < len / 2
+    // table3[len / 2 + j] = w_len^(3 * j) for j < len / 4
+    // w_len being the root of unity of order len, for every power of two len up to max_n
+    std::vector<T> roots, roots3;
+    std::vector<T> inv_roots, inv_roots3;
+
+    static constexpr std::size_t size_limit_of (unsigned long long x, std::size_t n = 1) {
+        return (x & 1) != 0 || n == (std::size_t(1) << (sizeof(std::size_t) * 8 - 1)) ? n : size_limit_of(x >> 1, n * 2);
+    }
+
+    // checked before any table is allocated
+    static std::size_t checked_max_size (std::size_t n) {
+        if (n == 0 || (n & (n - 1)) != 0 || n > size_limit()) {
+            mod_type_arith::raise("Transform size is not a power of two dividing upper bound - 1");
+        }
+
+        return n;
+    }
+
+    // root of unity of order n
+    // x^c, c the odd part of UB - 1, has order 2^k for any quadratic non residue x, found by Euler's criterion
+    static value_type root_of_unity (std::size_t n) {
+        const unsigned long long order = size_limit();
+        const value_type minus_one(T(UB - 1));
+
+        for (long long x = 2; x < UB && x < 10000; x++) {
+            if (value_type(T(x)).pow(((unsigned long long) UB - 1) / 2) == minus_one) {
+                return value_type(T(x)).pow(((unsigned long long) UB - 1) / order).pow(order / n);
+            }
+        }
+
+        mod_type_arith::raise("Upper bound is not prime");
+    }
+
+    static void fill (std::vector<T>& table, std::vector<T>& table3, value_type w) {
+        for (std::size_t len = table.size(); len >= 2; len /= 2) {
+            value_type x(T(1));
+
+            for (std::size_t j = 0; j < len / 2; j++) {
+                table[len / 2 + j] = x.val;
+                if (j < len / 4) {
+                    table3[len / 2 + j] = (x * x * x).val;
+                }
+                x *= w;
+            }
+
+            w *= w;
+        }
+    }
+
+    void check_size (std::size_t n) const {
+        if (n == 0 || (n & (n - 1)) != 0 || n > max_n) {
+            mod_type_arith::raise("Transform size is not a power of two up to max_size");
+        }
+    }
+
+    static T add (T a, T b) {
+        return value_type::mod_add_reduced(a, b);
+    }
+
+    static T sub (T a, T b) {
+        return value_type::mod_sub_reduced(a, b);
+    }
+
+    static T mul (T a, T b) {
+        return value_type::mod_mul_reduced(a, b);
+    }
+
+    // each radix-4 pass over blocks of len = 4q does the two radix-2 stages of lengths len and len / 2 at once,
+    // on a0..a3 = a[j], a[j + q], a[j + 2q], a[j + 3q] with w = w_len^j and i = w_len^q, a fourth root of unity
+    //     a[j]      = (a0 + a2) + (a1 + a3)
+    //     a[j + q]  = ((a0 + a2) - (a1 + a3)) * w^2
+    //     a[j + 2q] = ((a0 - a2) + (a1 - a3) * i) * w
+    //     a[j + 3q] = ((a0 - a2) - (a1 - a3) * i) * w^3
+    void dif (value_type* a, std::size_t n) const {
+        std::size_t len = n;
+
+        for (; len >= 4; len /= 4) {
+            std::size_t q = len / 4;
+            T i = roots[len / 2 + q];
+
+            for (std::size_t s = 0; s < n; s += len) {
+                value_type* p = a + s;
+
+                for (std::size_t j = 0; j < q; j++) {
+                    T t0 = add(p[j].val, p[j + 2 * q].val);
+                    T t1 = add(p[j + q].val, p[j + 3 * q].val);
+                    T t2 = sub(p[j].val, p[j + 2 * q].val);
+                    T t3 = mul(sub(p[j + q].val, p[j + 3 * q].val), i);
+
+                    p[j].val         = add(t0, t1);
+                    p[j + q].val     = mul(sub(t0, t1), roots[len / 4 + j]);
+                    p[j + 2 * q].val = mul(add(t2, t3), roots[len / 2 + j]);
+                    p[j + 3 * q].val = mul(sub(t2, t3), roots3[len / 2 + j]);
+                }
+            }
+        }
+
+        if (len == 2) {
+            for (std::size_t s = 0; s < n; s += 2) {
+                T u = a[s].val;
+                T v = a[s + 1].val;
+
+                a[s].val     = add(u, v);
+                a[s + 1].val = sub(u, v);
+            }
+        }
+    }
+
+    // reverses dif() pass by pass with inverse roots, leaving every value multiplied by n
+    void dit (value_type* a, std::size_t n) const {
+        std::size_t len = 4;
+
+        if ((n & 0x5555555555555555ull) == 0) {     // log2(n) is odd, so dif() finished with a radix-2 pass
+            for (std::size_t s = 0; s < n; s += 2) {
+                T u = a[s].val;
+                T v = a[s + 1].val;
+
+                a[s].val     = add(u, v);
+                a[s + 1].val = sub(u, v);
+            }
+
+            len = 8;
+        }
+
+        for (; len <= n; len *= 4) {
+            std::size_t q = len / 4;
+            T i = inv_roots[len / 2 + q];
+
+            for (std::size_t s = 0; s < n; s += len) {
+                value_type* p = a + s;
+
+                for (std::size_t j = 0; j < q; j++) {
+                    T u1 = mul(p[j + q].val, inv_roots[len / 4 + j]);
+                    T u2 = mul(p[j + 2 * q].val, inv_roots[len / 2 + j]);
+                    T u3 = mul(p[j + 3 * q].val, inv_roots3[len / 2 + j]);
+
+                    T s0 = add(p[j].val, u1);
+                    T s1 = sub(p[j].val, u1);
+                    T s2 = add(u2, u3);
+                    T s3 = mul(sub(u2, u3), i);
+
+                    p[j].val         = add(s0, s2);
+                    p[j + q].val     = add(s1, s3);
+                    p[j + 2 * q].val = sub(s0, s2);
+                    p[j + 3 * q].val = sub(s1, s3);
+                }
+            }
+        }
+    }
+
+    static void bit_reverse (value_type* a, std::size_t n) {
+        for (std::size_t i = 1, j = 0; i < n; i++) {
+            std::size_t bit = n >> 1;
+
+            for (; (j & bit) != 0; bit >>= 1) {
+                j ^= bit;
+            }
+            j ^= bit;
+
+            if (i < j) {
+                std::swap(a[i], a[j]);
+            }
+        }
+    }
+
+    static void scale (value_type* a, std::size_t n) {
+        T n_inv = value_type::mod_inv_reduced(T(n));
+
+        for (std::size_t i = 0; i < n; i++) {
+            a[i].val = mul(a[i].val, n_inv);
+        }
+    }
+
+    static std::vector<value_type> convolve_direct (const std::vector<value_type>& a, const std::vector<value_type>& b) {
+        std::vector<value_type> c(a.size() + b.size() - 1);
+
+        for (std::size_t i = 0; i < a.size(); i++) {
+            for (std::size_t j = 0; j < b.size(); j++) {
+                c[i + j].val = add(c[i + j].val, mul(a[i].val, b[j].val));
+            }
+        }
+
+        return c;
+    }
+};
+
+#endif // MOD_NTT_H_INCLUDED
@@ -0,0 +1,328 @@
+/* Bounded lock free ring buffers, with slots indexed by Mod_Type
+ * Spsc_Ring is for one producer thread and one consumer thread, Mpmc_Ring for any number of each
+ * Neither blocks, a push to a full ring or a pop from an empty ring fails instead
+ * When the number of slots is a power of two, indices are reduced with a mask
+ *
+ * License:
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include "atomic_type.h"
+#include "mod_type.h"
+
+#ifndef MOD_RING_H_INCLUDED
+#define MOD_RING_H_INCLUDED
+
+// may be defined beforehand, indices written by different threads are kept this many bytes apart
+// the rings are aligned to it, which heap allocation only honours from C++17 onwards
+#ifndef MOD_RING_CACHE_LINE
+#define MOD_RING_CACHE_LINE 64
+#endif
+
+// N slots, of which N - 1 can be filled at once, a full ring is told apart from an empty one by the free slot
+// Head and tail are Atomic_Mod_Type<std::size_t, N>, each on its own cache line,
+// next to a copy of the other index that is only refreshed when the ring looks full or empty
+// T is default constructed in every slot, and popped values are moved out
+template <typename T, std::size_t N>
+class Spsc_Ring {
+
+    static_assert(N >= 2,
+                  "Ring needs at least two slots");
+
+public:
+    using index_type = Mod_Type<std::size_t, (long long int) N>;
+
+    Spsc_Ring () : slots {new T[N]} {}
+
+    Spsc_Ring (const Spsc_Ring&) = delete;
+
+    Spsc_Ring& operator= (const Spsc_Ring&) = delete;
+
+    static constexpr std::size_t capacity () {
+        return N - 1;
+    }
+
+    // producer side
+
+    bool try_push (const T& a) {
+        return emplace(a);
+    }
+
+    bool try_push (T&& a) {
+        return emplace(std::move(a));
+    }
+
+    // pushes as many of a[0 .. n) as fit, and gives how many that was
+    // the whole batch is made visible to the consumer at once
+    std::size_t try_push (const T* a, std::size_t n) {
+        index_type t = tail.load(std::memory_order_relaxed);
+        std::size_t count = free_slots(t);
+
+        if (count < n) {
+            head_cache = head.load(std::memory_order_acquire);
+            count = free_slots(t);
+        }
+
+        count = count < n ? count : n;
+
+        for (std::size_t i = 0; i < count; i++) {
+            slots[(t + index_type(i)).value()] = a[i];
+        }
+
+        tail.store(t + index_type(count), std::memory_order_release);
+
+        return count;
+    }
+
+    // consumer side
+
+    bool try_pop (T& out) {
+        index_type h = head.load(std::memory_order_relaxed);
+
+        if (h == tail_cache) {
+            tail_cache = tail.load(std::memory_order_acquire);
+
+            if (h == tail_cache) {
+                return false;
+            }
+        }
+
+        out = std::move(slots[h.value()]);
+        head.store(h + index_type(1), std::memory_order_release);
+
+        return true;
+    }
+
+    // pops up to n values into out[0 .. n), and gives how many that was
+    std::size_t try_pop (T* out, std::size_t n) {
+        index_type h = head.load(std::memory_order_relaxed);
+        std::size_t count = (tail_cache - h).value();
+
+        if (count < n) {
+            tail_cache = tail.load(std::memory_order_acquire);
+            count = (tail_cache - h).value();
+        }
+
+        count = count < n ? count : n;
+
+        for (std::size_t i = 0; i < count; i++) {
+            out[i] = std::move(slots[(h + index_type(i)).value()]);
+        }
+
+        head.store(h + index_type(count), std::memory_order_release);
+
+        return count;
+    }
+
+    // either side, only a snapshot while the other side is running
+    std::size_t size () const {
+        return (tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire)).value();
+    }
+
+    bool empty () const {
+        return size() == 0;
+    }
+
+private:
+    std::unique_ptr<T[]> slots;
+
+    // written by the consumer
+    alignas(MOD_RING_CACHE_LINE) Atomic_Mod_Type<std::size_t, (long long int) N> head;
+    index_type tail_cache;
+
+    // written by the producer
+    alignas(MOD_RING_CACHE_LINE) Atomic_Mod_Type<std::size_t, (long long int) N> tail;
+    index_type head_cache;
+
+    std::size_t free_slots (const index_type& t) const {
+        return (head_cache - t - index_type(1)).value();
+    }
+
+    template <typename U>
+    bool emplace (U&& a) {
+        index_type t    = tail.load(std::memory_order_relaxed);
+        index_type next = t + index_type(1);
+
+        if (next == head_cache) {
+            head_cache = head.load(std::memory_order_acquire);
+
+            if (next == head_cache) {
+                return false;
+            }
+        }
+
+        slots[t.value()] = std::forward<U>(a);
+        tail.store(next, std::memory_order_release);
+
+        return true;
+    }
+};
+
+// All N slots can be filled at once
+// Positions count up freely and are reduced with Mod_Type<std::size_t, N> to find the slot,
+// and each slot carries a sequence number that says whether it is ready to be written or read
+// A push or pop claims its positions with one compare exchange, then fills or empties them without locking
+// T is default constructed in every slot, and its copy/move assignment must not throw
+template <typename T, std::size_t N>
+class Mpmc_Ring {
+
+    static_assert(N >= 2,
+                  "Ring needs at least two slots");
+
+public:
+    using index_type = Mod_Type<std::size_t, (long long int) N>;
+
+    Mpmc_Ring () : slots {new Slot[N]} {
+        for (std::size_t i = 0; i < N; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    Mpmc_Ring (const Mpmc_Ring&) = delete;
+
+    Mpmc_Ring& operator= (const Mpmc_Ring&) = delete;
+
+    static constexpr std::size_t capacity () {
+        return N;
+    }
+
+    bool try_push (const T& a) {
+        return try_push(&a, 1) == 1;
+    }
+
+    bool try_push (T&& a) {
+        std::size_t pos;
+
+        if (claim(enqueue_pos, 0, 1, pos) == 0) {
+            return false;
+        }
+
+        Slot& s = slot(pos);
+        s.value = std::move(a);
+        s.sequence.store(pos + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    // pushes as many of a[0 .. n) as there are free slots in a row, and gives how many that was
+    std::size_t try_push (const T* a, std::size_t n) {
+        std::size_t pos;
+        std::size_t count = claim(enqueue_pos, 0, n, pos);
+
+        for (std::size_t i = 0; i < count; i++) {
+            Slot& s = slot(pos + i);
+            s.value = a[i];
+            s.sequence.store(pos + i + 1, std::memory_order_release);
+        }
+
+        return count;
+    }
+
+    bool try_pop (T& out) {
+        return try_pop(&out, 1) == 1;
+    }
+
+    // pops up to n values into out[0 .. n), and gives how many that was
+    std::size_t try_pop (T* out, std::size_t n) {
+        std::size_t pos;
+        std::size_t count = claim(dequeue_pos, 1, n, pos);
+
+        for (std::size_t i = 0; i < count; i++) {
+            Slot& s = slot(pos + i);
+            out[i] = std::move(s.value);
+            s.sequence.store(pos + i + N, std::memory_order_release);
+        }
+
+        return count;
+    }
+
+    // only a snapshot while other threads are running
+    std::size_t size () const {
+        std::size_t pushed = enqueue_pos.load(std::memory_order_acquire);
+        std::size_t popped = dequeue_pos.load(std::memory_order_acquire);
+
+        return pushed > popped ? pushed - popped : 0;
+    }
+
+    bool empty () const {
+        return size() == 0;
+    }
+
+private:
+    // a slot at position pos has sequence pos when free, and pos + 1 when it holds a value
+    // once the value is popped, the sequence moves on to pos + N, the next position using the slot
+    struct Slot {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+
+    alignas(MOD_RING_CACHE_LINE) std::atomic<std::size_t> enqueue_pos {0};
+    alignas(MOD_RING_CACHE_LINE) std::atomic<std::size_t> dequeue_pos {0};
+
+    Slot& slot (std::size_t pos) const {
+        return slots[index_type(pos).value()];
+    }
+
+    // claims up to n ready positions in a row from counter, ready meaning sequence is pos + ready_offset
+    // gives the number claimed, and the first of them in pos
+    std::size_t claim (std::atomic<std::size_t>& counter, std::size_t ready_offset, std::size_t n, std::size_t& pos) {
+        n = n < N ? n : N;
+        pos = counter.load(std::memory_order_relaxed);
+
+        for (;;) {
+            std::size_t count = 0;
+
+            while (count < n && slot(pos + count).sequence.load(std::memory_order_acquire) == pos + count + ready_offset) {
+                count++;
+            }
+
+            if (count == 0) {
+                std::ptrdiff_t diff = std::ptrdiff_t(slot(pos).sequence.load(std::memory_order_acquire) - (pos + ready_offset));
+
+                // the slot has not come round yet, so the ring is full or empty
+                if (diff < 0) {
+                    return 0;
+                }
+
+                // another thread claimed pos first
+                pos = counter.load(std::memory_order_relaxed);
+                continue;
+            }
+
+            if (counter.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed, std::memory_order_relaxed)) {
+                return count;
+            }
+        }
+    }
+};
+
+#endif // MOD_RING_H_INCLUDED
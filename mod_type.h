@@ -30,11 +30,219 @@
  * For more information, please refer to <http://unlicense.org/>
  */
 
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
 #include <ostream>
 #include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include "check_stats.h"
 
-#ifndef MOD_TYPE_H_INCLUDED
-#define MOD_TYPE_H_INCLUDED
+#ifndef MOD_TYPE_H_INCLUDED
+#define MOD_TYPE_H_INCLUDED
+
+class ModTypeException : public std::runtime_error {
+public:
+    ModTypeException (std::string errMsg) : runtime_error(errMsg) {}
+private:
+};
+
+#if defined(__GNUC__)
+#define MOD_TYPE_COLD   __attribute__((noinline, cold))
+#elif defined(_MSC_VER)
+#define MOD_TYPE_COLD   __declspec(noinline)
+#else
+#define MOD_TYPE_COLD
+#endif
+
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define MOD_TYPE_EXCEPTIONS 1
+#else
+#define MOD_TYPE_EXCEPTIONS 0
+#endif
+
+// operations are usable in constant expressions from C++14 onwards
+#if __cplusplus >= 201402L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201402L)
+#define MOD_TYPE_CONSTEXPR constexpr
+#else
+#define MOD_TYPE_CONSTEXPR
+#endif
+
+#if defined(__SIZEOF_INT128__)
+#define MOD_TYPE_INT128 1
+#else
+#define MOD_TYPE_INT128 0
+#endif
+
+#if MOD_TYPE_INT128 || (defined(_MSC_VER) && defined(_M_X64))
+#define MOD_TYPE_MUL_HIGH_64 1
+#else
+#define MOD_TYPE_MUL_HIGH_64 0
+#endif
+
+#if !MOD_TYPE_INT128 && MOD_TYPE_MUL_HIGH_64
+#include <intrin.h>
+#endif
+
+// Reduction of unsigned values modulo a compile time constant, without hardware division
+namespace mod_type_arith {
+    // high half of the double width product a * b
+    template <typename U>
+    MOD_TYPE_CONSTEXPR U mul_high (U a, U b, std::true_type) {     // U is at most 32 bits, product fits in 64 bits
+        return U(((unsigned long long) a * b) >> std::numeric_limits<U>::digits);
+    }
+
+#if MOD_TYPE_MUL_HIGH_64
+    template <typename U>
+    MOD_TYPE_CONSTEXPR U mul_high (U a, U b, std::false_type) {    // U is 64 bits
+#if MOD_TYPE_INT128
+        return U(((unsigned __int128) a * b) >> 64);
+#else
+        return U(__umulh(a, b));
+#endif
+    }
+#endif
+
+    template <typename U>
+    MOD_TYPE_CONSTEXPR U mul_high (U a, U b) {
+        return mul_high<U>(a, b, std::integral_constant<bool, (sizeof(U) <= 4)>());
+    }
+
+    template <typename U>
+    struct has_mul_high : std::integral_constant<bool, (sizeof(U) <= 4 || MOD_TYPE_MUL_HIGH_64)> {};
+
+    template <unsigned long long M>
+    struct is_power_of_two : std::integral_constant<bool, (M & (M - 1)) == 0> {};
+
+    // Barrett reduction, x mod M = x - floor(x * m / 2^bits) * M with m = floor((2^bits - 1) / M)
+    // the estimated quotient is at most one below the real one, so one conditional subtraction corrects it
+    // a power of two M is reduced with a mask instead
+    template <typename U, unsigned long long M>
+    struct Barrett {
+        static const U modulus    = U(M);
+        static const U multiplier = U(std::numeric_limits<U>::max() / M);
+
+        static MOD_TYPE_CONSTEXPR U reduce (U x) {
+            return is_power_of_two<M>::value ? U(x & U(M - 1)) : reduce(x, has_mul_high<U>());
+        }
+
+    private:
+        static MOD_TYPE_CONSTEXPR U reduce (U x, std::true_type) {
+            U r = U(x - U(mul_high<U>(x, multiplier) * modulus));
+
+            return r >= modulus ? U(r - modulus) : r;
+        }
+
+        static MOD_TYPE_CONSTEXPR U reduce (U x, std::false_type) {
+            return U(x % modulus);
+        }
+    };
+
+#if MOD_TYPE_INT128
+    constexpr int leading_zeros_64 (unsigned long long x, int n = 0) {
+        return (x >> 63) != 0 ? n : leading_zeros_64(x << 1, n + 1);
+    }
+
+    // remainder of a 128 by 64 bit division by the constant M, using a precomputed reciprocal
+    // see Moller and Granlund, Improved division by invariant integers
+    template <unsigned long long M>
+    struct Reciprocal_64 {
+        static constexpr int shift = leading_zeros_64(M);
+        static constexpr unsigned long long divisor = M << shift;     // normalised, top bit set
+        static constexpr unsigned long long inverse =
+            (unsigned long long) (((((unsigned __int128) ~divisor) << 64) | ~0ull) / divisor);
+
+        // a * b mod M, for a, b in [0, M)
+        static MOD_TYPE_CONSTEXPR unsigned long long mul_mod (unsigned long long a, unsigned long long b) {
+            // shifting a up front normalises the product, which is then below divisor * 2^64
+            unsigned __int128 product = (unsigned __int128) (a << shift) * b;
+
+            return reduce_normalised((unsigned long long) (product >> 64), (unsigned long long) product) >> shift;
+        }
+
+    private:
+        // remainder of (high * 2^64 + low) by divisor, requires high < divisor
+        static MOD_TYPE_CONSTEXPR unsigned long long reduce_normalised (unsigned long long high, unsigned long long low) {
+            unsigned __int128 q = (unsigned __int128) inverse * high + ((((unsigned __int128) high) << 64) | low);
+            unsigned long long q_high = (unsigned long long) (q >> 64) + 1;
+            unsigned long long q_low  = (unsigned long long) q;
+            unsigned long long r      = low - q_high * divisor;
+
+            if (r > q_low) {
+                r += divisor;
+            }
+            if (r >= divisor) {
+                r -= divisor;
+            }
+
+            return r;
+        }
+    };
+#endif
+
+    // whether a * b mod M can be done as one widening multiply and one reduction
+    template <typename U>
+    struct has_wide_mul : std::integral_constant<bool, (sizeof(U) <= 4 || MOD_TYPE_INT128)> {};
+
+    // a * b mod M, for a, b in [0, M)
+    template <typename U, unsigned long long M>
+    MOD_TYPE_CONSTEXPR U mul_mod (U a, U b, std::true_type) {      // U is at most 32 bits, product fits in 64 bits
+        return U(Barrett<unsigned long long, M>::reduce((unsigned long long) a * b));
+    }
+
+#if MOD_TYPE_INT128
+    template <typename U, unsigned long long M>
+    MOD_TYPE_CONSTEXPR U mul_mod (U a, U b, std::false_type) {     // U is 64 bits
+        return U(Reciprocal_64<M>::mul_mod(a, b));
+    }
+#endif
+
+    template <typename U, unsigned long long M>
+    MOD_TYPE_CONSTEXPR U mul_mod (U a, U b) {
+        return mul_mod<U, M>(a, b, std::integral_constant<bool, (sizeof(U) <= 4)>());
+    }
+
+    [[noreturn]] MOD_TYPE_COLD
+    inline void raise (const char* message) {
+#if MOD_TYPE_EXCEPTIONS
+        throw ModTypeException(message);
+#else
+        std::fputs(message, stderr);
+        std::fputc('\n', stderr);
+        std::abort();
+#endif
+    }
+
+    // a < 0, without comparing an unsigned a against 0
+    template <typename U>
+    constexpr bool is_negative (U a, std::true_type) {
+        return a < 0;
+    }
+
+    template <typename U>
+    constexpr bool is_negative (U, std::false_type) {
+        return false;
+    }
+
+    template <typename U>
+    constexpr bool is_negative (U a) {
+        return is_negative(a, std::is_signed<U>());
+    }
+
+    // a + b mod m, for a, b in [0, m), never exceeds m on the way
+    template <typename U>
+    MOD_TYPE_CONSTEXPR U add_mod (U a, U b, U m) {
+        return a >= U(m - b) ? U(a - U(m - b)) : U(a + b);
+    }
+
+    // a - b mod m, for a, b in [0, m)
+    template <typename U>
+    MOD_TYPE_CONSTEXPR U sub_mod (U a, U b, U m) {
+        return a >= b ? U(a - b) : U(a + U(m - b));
+    }
+}
 
 template <typename T, long long int UB>
 class Mod_Type {
@@ -42,41 +250,48 @@ class Mod_Type {
     static_assert(std::is_integral<T>::value,
                   "Type must be integral");
 
-    static_assert(UB <= std::numeric_limits<T>::max(),
-                  "Upper bound exceeds type maximum possible value");
+    // UB may be one past the maximum of T, and 0 stands for 2^bits of an unsigned T,
+    // the only way to write 2^64, so that wrapping around the whole type can be expressed
+    static_assert(UB == 0 || (unsigned long long) (UB - 1) <= (unsigned long long) std::numeric_limits<T>::max(),
+                  "Upper bound exceeds type maximum possible value plus one");
 
-    static_assert(UB > 0,
-                  "Upper bound is not positive(and non-zero)");
+    static_assert(UB > 0 || (UB == 0 && std::is_unsigned<T>::value),
+                  "Upper bound is not positive(and non-zero), nor 0 for the full width of an unsigned type");
+
+    using unsigned_T   = typename std::make_unsigned<T>::type;
+    using reduction    = mod_type_arith::Barrett<unsigned_T, (unsigned long long) UB>;
+    using power_of_two = mod_type_arith::is_power_of_two<(unsigned long long) UB>;
 
 public:
-    Mod_Type() : val {0} {}
+    MOD_TYPE_CONSTEXPR Mod_Type() : val {0} {}
 
-    Mod_Type(T a) : val {mod_val(a)} {}
+    MOD_TYPE_CONSTEXPR Mod_Type(T a) : val {mod_val(a)} {}
 
-    Mod_Type(const Mod_Type& a) : val {mod_val(a.val)} {}
+    MOD_TYPE_CONSTEXPR Mod_Type(const Mod_Type& a) : val {a.val} {}
 
-    Mod_Type operator= (const Mod_Type& a) {
-        this->val = mod_val(a.val);
+    MOD_TYPE_CONSTEXPR Mod_Type operator= (const Mod_Type& a) {
+        this->val = a.val;
         return *this;
     }
 
-    Mod_Type operator= (const T& a) {
+    MOD_TYPE_CONSTEXPR Mod_Type operator= (const T& a) {
         this->val = mod_val(a);
         return *this;
     }
 
-    operator T () const {
+    MOD_TYPE_CONSTEXPR operator T () const {
         return val;
     }
 
     template<typename ANY_T>
     operator ANY_T() const = delete;
 
-    T value () const {
+    MOD_TYPE_CONSTEXPR T value () const {
         return this->val;
     }
 
-    T bound () const {
+    // 0 when the upper bound does not fit in T
+    MOD_TYPE_CONSTEXPR T bound () const {
         return this->upper_bound;
     }
 
@@ -85,185 +300,326 @@ public:
         return out;
     }
 
-    Mod_Type operator+ () const {
+    MOD_TYPE_CONSTEXPR Mod_Type operator+ () const {
         return *this;
     }
 
-    Mod_Type operator- () const {
-        return mod_val(-val);
+    MOD_TYPE_CONSTEXPR Mod_Type operator- () const {
+        return reduced(mod_sub_reduced(0, val));
     }
 
-    friend Mod_Type operator+ (const Mod_Type& a, const Mod_Type& b) {
-        return mod_add(a.val, b.val);
+    friend MOD_TYPE_CONSTEXPR Mod_Type operator+ (const Mod_Type& a, const Mod_Type& b) {
+        return reduced(mod_add_reduced(a.val, b.val));
     }
 
-    friend Mod_Type operator+ (const Mod_Type& a, const T& b) {
-        return mod_add(a.val, b);
+    friend MOD_TYPE_CONSTEXPR Mod_Type operator+ (const Mod_Type& a, const T& b) {
+        return reduced(mod_add(a.val, b));
     }
 
-    friend Mod_Type operator+ (const T& b, const Mod_Type& a) {
-        return mod_add(b,     a.val);
+    friend MOD_TYPE_CONSTEXPR Mod_Type operator+ (const T& b, const Mod_Type& a) {
+        return reduced(mod_add(b,     a.val));
     }
 
-    friend Mod_Type operator- (const Mod_Type& a, const T& b) {
-        return mod_sub(a.val, b);
+    friend MOD_TYPE_CONSTEXPR Mod_Type operator- (const Mod_Type& a, const Mod_Type& b) {
+        return reduced(mod_sub_reduced(a.val, b.val));
     }
 
-    friend Mod_Type operator- (const T& b, const Mod_Type& a) {
-        return mod_sub(b,     a.val);
+    friend MOD_TYPE_CONSTEXPR Mod_Type operator- (const Mod_Type& a, const T& b) {
+        return reduced(mod_sub(a.val, b));
     }
 
-    friend Mod_Type operator* (const Mod_Type& a, const Mod_Type& b) {
-        return mod_mul(a.val, b.val);
+    friend MOD_TYPE_CONSTEXPR Mod_Type operator- (const T& b, const Mod_Type& a) {
+        return reduced(mod_sub(b,     a.val));
     }
 
-    friend Mod_Type operator* (const Mod_Type& a, const T& b) {
-        return mod_mul(a.val, b);
+    friend MOD_TYPE_CONSTEXPR Mod_Type operator* (const Mod_Type& a, const Mod_Type& b) {
+        return reduced(mod_mul_reduced(a.val, b.val));
     }
 
-    friend Mod_Type operator* (const T& b, const Mod_Type& a) {
-        return mod_mul(b,     a.val);
+    friend MOD_TYPE_CONSTEXPR Mod_Type operator* (const Mod_Type& a, const T& b) {
+        return reduced(mod_mul(a.val, b));
     }
 
-    Mod_Type operator++ () {
+    friend MOD_TYPE_CONSTEXPR Mod_Type operator* (const T& b, const Mod_Type& a) {
+        return reduced(mod_mul(b,     a.val));
+    }
+
+    MOD_TYPE_CONSTEXPR Mod_Type operator++ () {
         return (*this) += 1;
     }
 
-    Mod_Type operator++ (int) {
+    MOD_TYPE_CONSTEXPR Mod_Type operator++ (int) {
         T ret = val;
         (*this) += 1;
-        return ret;
+        return reduced(ret);
     }
 
-    Mod_Type operator-- () {
+    MOD_TYPE_CONSTEXPR Mod_Type operator-- () {
         return (*this) -= 1;
     }
 
-    Mod_Type operator-- (int) {
+    MOD_TYPE_CONSTEXPR Mod_Type operator-- (int) {
         T ret = val;
         (*this) -= 1;
-        return ret;
+        return reduced(ret);
     }
 
-    Mod_Type operator+= (const Mod_Type& a) {
-        this->val = mod_add(this->val, a.val);
+    MOD_TYPE_CONSTEXPR Mod_Type operator+= (const Mod_Type& a) {
+        this->val = mod_add_reduced(this->val, a.val);
         return *this;
     }
 
-    Mod_Type operator+= (const T& a) {
-        this->val = mod_add(val, mod_val(a));
+    MOD_TYPE_CONSTEXPR Mod_Type operator+= (const T& a) {
+        this->val = mod_add(val, a);
         return *this;
     }
 
-    Mod_Type operator-= (const Mod_Type& a) {
-        this->val = mod_add(val, -a.val);
+    MOD_TYPE_CONSTEXPR Mod_Type operator-= (const Mod_Type& a) {
+        this->val = mod_sub_reduced(this->val, a.val);
         return *this;
     }
 
-    Mod_Type operator-= (const T& a) {
-        this->val = mod_add(val, -mod_val(a));
+    MOD_TYPE_CONSTEXPR Mod_Type operator-= (const T& a) {
+        this->val = mod_sub(val, a);
         return *this;
     }
 
-    Mod_Type operator *= (const Mod_Type& a) {
-        this->val = mod_mul(this->val, a.val);
+    MOD_TYPE_CONSTEXPR Mod_Type operator *= (const Mod_Type& a) {
+        this->val = mod_mul_reduced(this->val, a.val);
         return *this;
     }
 
-    Mod_Type operator *= (const T& a) {
+    MOD_TYPE_CONSTEXPR Mod_Type operator *= (const T& a) {
         this->val = mod_mul(this->val, a);
         return *this;
     }
 
-    friend bool operator== (const Mod_Type& a, const Mod_Type& b) {
+    // throws ModTypeException when the divisor has no inverse, see inverse()
+    friend MOD_TYPE_CONSTEXPR Mod_Type operator/ (const Mod_Type& a, const Mod_Type& b) {
+        return reduced(mod_mul_reduced(a.val, mod_inv_reduced(b.val)));
+    }
+
+    friend MOD_TYPE_CONSTEXPR Mod_Type operator/ (const Mod_Type& a, const T& b) {
+        return reduced(mod_mul_reduced(a.val, mod_inv_reduced(mod_val(b))));
+    }
+
+    friend MOD_TYPE_CONSTEXPR Mod_Type operator/ (const T& b, const Mod_Type& a) {
+        return reduced(mod_mul_reduced(mod_val(b), mod_inv_reduced(a.val)));
+    }
+
+    MOD_TYPE_CONSTEXPR Mod_Type operator/= (const Mod_Type& a) {
+        this->val = mod_mul_reduced(this->val, mod_inv_reduced(a.val));
+        return *this;
+    }
+
+    MOD_TYPE_CONSTEXPR Mod_Type operator/= (const T& a) {
+        this->val = mod_mul_reduced(this->val, mod_inv_reduced(mod_val(a)));
+        return *this;
+    }
+
+    // value^e by square and multiply, at most 2 * bit length of e multiplications
+    MOD_TYPE_CONSTEXPR Mod_Type pow (unsigned long long e) const {
+        return reduced(mod_pow_reduced(this->val, e));
+    }
+
+    // x with value * x congruent to 1, which exists when value and the upper bound share no factor
+    // throws ModTypeException otherwise, for 0 and for an even value with an even upper bound, for example
+    MOD_TYPE_CONSTEXPR Mod_Type inverse () const {
+        return reduced(mod_inv_reduced(this->val));
+    }
+
+    friend MOD_TYPE_CONSTEXPR bool operator== (const Mod_Type& a, const Mod_Type& b) {
         return a.val == b.val;
     }
 
-    friend bool operator== (const Mod_Type& a, const T& b) {
-        return a == Mod_Type(b);
+    friend MOD_TYPE_CONSTEXPR bool operator== (const Mod_Type& a, const T& b) {
+        return a.val == mod_val(b);
     }
 
-    friend bool operator== (const T& b, const Mod_Type& a) {
+    friend MOD_TYPE_CONSTEXPR bool operator== (const T& b, const Mod_Type& a) {
         return a == b;
     }
 
-    friend bool operator!= (const Mod_Type& a, const Mod_Type& b) {
+    friend MOD_TYPE_CONSTEXPR bool operator!= (const Mod_Type& a, const Mod_Type& b) {
         return !(a == b);
     }
 
-    friend bool operator!= (const Mod_Type& a, const T& b) {
+    friend MOD_TYPE_CONSTEXPR bool operator!= (const Mod_Type& a, const T& b) {
         return !(a == b);
     }
 
-    friend bool operator!= (const T& b, const Mod_Type& a) {
+    friend MOD_TYPE_CONSTEXPR bool operator!= (const T& b, const Mod_Type& a) {
         return !(a == b);
     }
 
 private:
-    static const T upper_bound = UB;
+    static const T upper_bound = (unsigned long long) (UB - 1) == (unsigned long long) std::numeric_limits<T>::max()
+                                 ? T(0) : T(UB);
+
+    // for a power of two upper bound, a value mod upper_bound is its low bits
+    static const unsigned_T mask = unsigned_T(UB - 1);
+
     T val;
 
-    static T mod_val (T a) {
+    struct reduced_tag {};
+
+    // batch operations work on values already in [0, upper_bound)
+    template <typename, long long int> friend class Mod_Batch;
+    template <typename, long long int, std::size_t> friend class Mod_Array;
+    template <typename, long long int> friend class Atomic_Mod_Type;
+    template <typename, long long int> friend class Mod_Ntt;
+    template <typename, long long int> friend class Mod_Matrix;
+
+    MOD_TYPE_CONSTEXPR Mod_Type(T a, reduced_tag) : val {a} {}
+
+    // a is already in [0, upper_bound)
+    static MOD_TYPE_CONSTEXPR Mod_Type reduced (T a) {
+        return Mod_Type(a, reduced_tag());
+    }
+
+    // counted as a check, of a value under 0 or from UB upwards
+    static MOD_TYPE_CONSTEXPR T mod_val (T a) {
+        CHECK_STATS_CHECK(stats_site(), mod_type_arith::is_negative(a),
+                          !mod_type_arith::is_negative(a) && (unsigned long long) a > (unsigned long long) (UB - 1));
+        return mod_val(a, power_of_two());
+    }
+
+#if CHECK_STATS
+    static std::size_t stats_site () {
+        static const std::size_t site = check_stats::register_site(
+            check_stats::site_name("Mod_Type", check_stats::type_name<T>(), UB));
+        return site;
+    }
+#endif
+
+    // two's complement makes the low bits right for negative a as well,
+    // and for the full width of an unsigned T the mask keeps every bit
+    static MOD_TYPE_CONSTEXPR T mod_val (T a, std::true_type) {
+        return T(unsigned_T(a) & mask);
+    }
+
+    static MOD_TYPE_CONSTEXPR T mod_val (T a, std::false_type) {
         if (a < 0) {
-            if (a == std::numeric_limits<T>::min()) {
-                // prevent negating from wrapping back to same value
-                // this is to deal with case where number of negative values is one greater than number of non-negative values
-                // aka two's complement
-                a += upper_bound;   // would not change the result in modulo arithmetic
+            // -(a + 1) can always be negated safely, including the minimum value of two's complement
+            // a mod upper_bound = upper_bound - 1 - (-(a + 1) mod upper_bound)
+            return T(upper_bound - 1 - T(reduction::reduce(unsigned_T(-(a + 1)))));
+        }
+
+        return T(reduction::reduce(unsigned_T(a)));
+    }
+
+    // both operands already in [0, upper_bound)
+    // a power of two upper_bound divides the modulus of unsigned_T, so the sum may wrap before it is masked
+    static MOD_TYPE_CONSTEXPR T mod_add_reduced (T a, T b) {
+        return power_of_two::value
+               ? T(unsigned_T(unsigned_T(a) + unsigned_T(b)) & mask)
+               : T(mod_type_arith::add_mod<unsigned_T>(unsigned_T(a), unsigned_T(b), unsigned_T(upper_bound)));
+    }
+
+    static MOD_TYPE_CONSTEXPR T mod_sub_reduced (T a, T b) {
+        return power_of_two::value
+               ? T(unsigned_T(unsigned_T(a) - unsigned_T(b)) & mask)
+               : T(mod_type_arith::sub_mod<unsigned_T>(unsigned_T(a), unsigned_T(b), unsigned_T(upper_bound)));
+    }
+
+    static MOD_TYPE_CONSTEXPR T mod_add (T a, T b) {
+        return mod_add_reduced(mod_val(a), mod_val(b));
+    }
+
+    static MOD_TYPE_CONSTEXPR T mod_sub (T a, T b) {
+        return mod_sub_reduced(mod_val(a), mod_val(b));
+    }
+
+    static MOD_TYPE_CONSTEXPR T mod_mul (T a, T b) {
+        return mod_mul_reduced(mod_val(a), mod_val(b));
+    }
+
+    // a already in [0, upper_bound)
+    static MOD_TYPE_CONSTEXPR T mod_pow_reduced (T a, unsigned long long e) {
+        T acc = mod_val(1);
+
+        while (e != 0) {
+            if ((e & 1) != 0) {
+                acc = mod_mul_reduced(acc, a);
             }
 
-            a = -a;
-            a = a % upper_bound;
+            e >>= 1;
 
-            if (a != 0) {
-                a = upper_bound - a;
+            if (e != 0) {
+                a = mod_mul_reduced(a, a);
             }
         }
-        else {
-            a = a % upper_bound;
+
+        return acc;
+    }
+
+    // a already in [0, upper_bound)
+    static MOD_TYPE_CONSTEXPR T mod_inv_reduced (T a) {
+        return mod_inv_reduced(a, power_of_two());
+    }
+
+    // only odd a is invertible, except that everything is with upper_bound 1
+    // Newton's iteration x = x * (2 - a * x) doubles the number of correct low bits,
+    // and x = a is already correct in the low 3 bits, so 5 steps cover 64 bits
+    static MOD_TYPE_CONSTEXPR T mod_inv_reduced (T a, std::true_type) {
+        if ((unsigned_T(a) & 1) == 0 && mask != 0) {
+            mod_type_arith::raise("Value has no inverse modulo upper bound");
+        }
+
+        unsigned long long x = unsigned_T(a);
+
+        for (int i = 0; i < 5; i++) {
+            x *= 2 - (unsigned long long) unsigned_T(a) * x;
         }
 
-        return a;
+        return T(unsigned_T(x) & mask);
     }
 
-    static T mod_add (T a, T b) {
-        a = mod_val(a);
-        b = mod_val(b);
+    // extended Euclidean algorithm, on the width of T so that 32 bit types use 32 bit division
+    // the coefficient t of a alternates in sign and never exceeds upper_bound in magnitude, so fits in long long
+    static MOD_TYPE_CONSTEXPR T mod_inv_reduced (T a, std::false_type) {
+        unsigned_T r     = unsigned_T(upper_bound);
+        unsigned_T new_r = unsigned_T(a);
+        long long t      = 0;
+        long long new_t  = 1;
 
-        T space_left_a;
+        while (new_r != 0) {
+            unsigned_T q = unsigned_T(r / new_r);
 
-        while (true) {
-            space_left_a = std::numeric_limits<T>::max() - a;
+            long long next_t = t - (long long) q * new_t;
+            t     = new_t;
+            new_t = next_t;
 
-            if (space_left_a < b) { // overflow
-                // b must be <= upper_bound due to mod_val above
-                // b also > upper_bound - a, since b > space_left_a
-                // and space_left_a >= upper_bound - a
+            unsigned_T next_r = unsigned_T(r - q * new_r);
+            r     = new_r;
+            new_r = next_r;
+        }
 
-                // add portion of b to a that results in 0
-                b -= upper_bound - a;
-                a = 0;
-            }
-            else {
-                a += b;
-                break;
-            }
+        if (r != 1) {
+            mod_type_arith::raise("Value has no inverse modulo upper bound");
         }
 
-        return mod_val(a);
+        return T(t < 0 ? t + UB : t);
     }
 
-    static T mod_sub (T a, T b) {
-        a =  mod_val(a);
-        b = -mod_val(b);
+    // both operands already in [0, upper_bound)
+    static MOD_TYPE_CONSTEXPR T mod_mul_reduced (T a, T b) {
+        return mod_mul_reduced(a, b, power_of_two(), mod_type_arith::has_wide_mul<unsigned_T>());
+    }
 
-        return mod_add(a, b);
+    // low bits of the product, which a wrapping multiply gives whatever the width of T
+    template <typename WIDE>
+    static MOD_TYPE_CONSTEXPR T mod_mul_reduced (T a, T b, std::true_type, WIDE) {
+        return T(unsigned_T((unsigned long long) unsigned_T(a) * unsigned_T(b)) & mask);
     }
 
-    static T mod_mul (T a, T b) {
-        a = mod_val(a);
-        b = mod_val(b);
+    // one widening multiply, then one reduction
+    static MOD_TYPE_CONSTEXPR T mod_mul_reduced (T a, T b, std::false_type, std::true_type) {
+        return T(mod_type_arith::mul_mod<unsigned_T, (unsigned long long) UB>(unsigned_T(a), unsigned_T(b)));
+    }
 
+    // no wider type available, so multiply in portions that do not overflow
+    static MOD_TYPE_CONSTEXPR T mod_mul_reduced (T a, T b, std::false_type, std::false_type) {
         if (a == 0 || b == 0) {
             return 0;
         }
@@ -275,16 +631,16 @@ private:
         while (true) {
             if (max_mutliplier_a < b) { // overflow
                 // multiply by mutlipliable portion first
-                acc = mod_add(acc, mod_val(a * max_mutliplier_a));
+                acc = mod_add_reduced(acc, mod_val(T(a * max_mutliplier_a)));
                 b -= max_mutliplier_a;
             }
             else {
-                acc = mod_add(acc, a * b);
+                acc = mod_add_reduced(acc, mod_val(T(a * b)));
                 break;
             }
         }
 
-        return mod_val(acc);
+        return acc;
     }
 };
 
@@ -0,0 +1,750 @@
+/* Array of Range_Type values packed into as few bits as the range needs
+ * A value of Range_Type<T, F, L> is stored as value - F in bit_length(L - F) bits, ceil(log2(L - F + 1))
+ * Values are validated as they enter the array, as in Range_Vector, reads are not checked again
+ * Arrays serialize to and from a compact little endian binary format
+ *
+ * License:
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "range_type.h"
+#include "range_vector.h"
+
+#ifndef PACKED_RANGE_ARRAY_H_INCLUDED
+#define PACKED_RANGE_ARRAY_H_INCLUDED
+
+// x86 decode kernels are compiled with per function target attributes and picked at runtime, as in mod_array.h
+// PACKED_RANGE_SIMD may be defined beforehand to cap the level used, 0 for scalar only, 1 for up to AVX2
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PACKED_RANGE_X86 1
+#include <immintrin.h>
+#else
+#define PACKED_RANGE_X86 0
+#endif
+
+#ifndef PACKED_RANGE_SIMD
+#define PACKED_RANGE_SIMD 2
+#endif
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ || defined(_M_X64) || defined(_M_IX86)
+#define PACKED_RANGE_LITTLE_ENDIAN 1
+#else
+#define PACKED_RANGE_LITTLE_ENDIAN 0
+#endif
+
+// fully unrolls a loop over a group of 64 values, so every shift in it is a constant
+#if defined(__GNUC__)
+#define PACKED_RANGE_UNROLL _Pragma("GCC unroll 64")
+#else
+#define PACKED_RANGE_UNROLL
+#endif
+
+namespace packed_range {
+    // 0 scalar, 1 AVX2, 2 AVX-512, best available on the running machine, detected once
+    inline int simd_level () {
+#if PACKED_RANGE_X86
+        static const int level = [] {
+            __builtin_cpu_init();
+            if (PACKED_RANGE_SIMD >= 2 && __builtin_cpu_supports("avx512f")) {
+                return 2;
+            }
+            if (PACKED_RANGE_SIMD >= 1 && __builtin_cpu_supports("avx2")) {
+                return 1;
+            }
+            return 0;
+        }();
+
+        return level;
+#else
+        return 0;
+#endif
+    }
+
+    constexpr unsigned bit_length (unsigned long long x, unsigned n = 0) {
+        return x == 0 ? n : bit_length(x >> 1, n + 1);
+    }
+
+    // Packed data error    reason
+    [[noreturn]] RANGE_TYPE_COLD
+    inline void raise (const char* reason) {
+        std::string error_message = std::string("Packed data error    ") + reason;
+
+#if RANGE_TYPE_EXCEPTIONS
+        throw RangeTypeException(error_message);
+#else
+        std::fputs(error_message.c_str(), stderr);
+        std::fputc('\n', stderr);
+        std::abort();
+#endif
+    }
+}
+
+// Values are kept in 64 bit words, value i in bits [i * bits, (i + 1) * bits) counting from bit 0 of word 0,
+// so a value may straddle two words
+// One spare word past the last value lets every read and write touch two words without a branch,
+// and bits past the last value are always 0
+//
+// Bulk operations return the index of the first value found outside [F, L], or npos if there is none,
+// handling it under Policy as Range_Vector does
+//
+// Serialized form, every integer little endian
+//     4 bytes      "PRA1"
+//     1 byte       bits per value
+//     8 bytes      F, then 8 bytes L, two's complement
+//     8 bytes      number of values n
+//     ceil(n * bits / 8) bytes holding the values, laid out as in the words
+template <typename T, long long int F, long long int L, typename Policy = Throw_On_Violation>
+class Packed_Range_Array {
+public:
+    using value_type = Range_Type<T, F, L, Policy>;
+
+    static const std::size_t npos = std::size_t(-1);
+
+    // bits per value, 0 when F == L
+    static constexpr unsigned bits = packed_range::bit_length((unsigned long long) L - (unsigned long long) F);
+
+    class const_iterator;
+
+    Packed_Range_Array () : words(1), count {0} {}
+
+    // n copies of F
+    explicit Packed_Range_Array (std::size_t n) : words(words_for(n)), count {n} {}
+
+    // unchecked, the value is already in range
+    value_type operator[] (std::size_t i) const {
+        return value_type(value_of(get(i)), typename value_type::unchecked_tag());
+    }
+
+    void set (std::size_t i, const value_type& a) {
+        put(i, offset_of(a.value()));
+    }
+
+    const_iterator begin () const {
+        return const_iterator(this, 0);
+    }
+
+    const_iterator end () const {
+        return const_iterator(this, this->count);
+    }
+
+    std::size_t size () const {
+        return this->count;
+    }
+
+    bool empty () const {
+        return this->count == 0;
+    }
+
+    // bytes taken by the packed values, including the spare word
+    std::size_t memory_size () const {
+        return words.size() * sizeof(std::uint64_t);
+    }
+
+    void reserve (std::size_t n) {
+        words.reserve(words_for(n));
+    }
+
+    void clear () {
+        words.assign(1, 0);
+        this->count = 0;
+    }
+
+    void push_back (const value_type& a) {
+        grow(1);
+        put_new(this->count - 1, offset_of(a.value()));
+    }
+
+    std::size_t push_back (T a) {
+        return append(&a, 1);
+    }
+
+    std::size_t append (const T* a, std::size_t n) {
+        return store(a, n);
+    }
+
+    std::size_t append (const std::vector<T>& a) {
+        return append(a.data(), a.size());
+    }
+
+    std::size_t assign (const T* a, std::size_t n) {
+        clear();
+
+        return store(a, n);
+    }
+
+    std::size_t assign (const std::vector<T>& a) {
+        return assign(a.data(), a.size());
+    }
+
+    // out[k] = value first + k, for k < n, first + n must be at most size()
+    void decode (std::size_t first, std::size_t n, T* out) const {
+        std::size_t i = 0;
+
+#if PACKED_RANGE_X86
+        // vector kernels start on a multiple of 8 values, which is a whole number of bytes
+        if (vectorised && packed_range::simd_level() != 0) {
+            for (; i < n && (first + i) % 8 != 0; i++) {
+                out[i] = value_of(get(first + i));
+            }
+
+            switch (packed_range::simd_level()) {
+                case 2  : i += decode_avx512(first + i, n - i, out + i); break;
+                default : i += decode_avx2(first + i, n - i, out + i);   break;
+            }
+        }
+#endif
+
+        for (; i < n && (first + i) % 64 != 0; i++) {
+            out[i] = value_of(get(first + i));
+        }
+
+        for (; i + 64 <= n; i += 64) {
+            unpack_group(words.data() + (first + i) / 64 * bits, out + i);
+        }
+
+        for (; i < n; i++) {
+            out[i] = value_of(get(first + i));
+        }
+    }
+
+    std::vector<T> decode () const {
+        std::vector<T> result(this->count);
+        decode(0, this->count, result.data());
+        return result;
+    }
+
+    std::size_t serialized_size () const {
+        return header_size + payload_size(this->count);
+    }
+
+    std::vector<unsigned char> serialize () const {
+        std::vector<unsigned char> result(serialized_size());
+        unsigned char* p = result.data();
+
+        p[0] = 'P';
+        p[1] = 'R';
+        p[2] = 'A';
+        p[3] = '1';
+        p[4] = (unsigned char) bits;
+        write_le((unsigned long long) F, p + 5);
+        write_le((unsigned long long) L, p + 13);
+        write_le((unsigned long long) this->count, p + 21);
+
+        p += header_size;
+        for (std::size_t k = 0; k < payload_size(this->count); k++) {
+            p[k] = (unsigned char) (words[k / 8] >> (k % 8 * 8));
+        }
+
+        return result;
+    }
+
+    // throws RangeTypeException when data is not an array of this F and L, is cut short,
+    // or holds a value outside [F, L]
+    static Packed_Range_Array deserialize (const unsigned char* data, std::size_t size) {
+        if (size < header_size || data[0] != 'P' || data[1] != 'R' || data[2] != 'A' || data[3] != '1') {
+            packed_range::raise("Not a serialized Packed_Range_Array");
+        }
+
+        if (data[4] != bits || read_le(data + 5) != (unsigned long long) F || read_le(data + 13) != (unsigned long long) L) {
+            packed_range::raise("Serialized array has a different range");
+        }
+
+        unsigned long long n = read_le(data + 21);
+
+        if (bits != 0 && n > (size - header_size) * 8 / bits) {
+            packed_range::raise("Serialized array is cut short");
+        }
+
+        Packed_Range_Array result(n);
+        const unsigned char* p = data + header_size;
+
+        for (std::size_t k = 0; k < payload_size(n); k++) {
+            result.words[k / 8] |= std::uint64_t(p[k]) << (k % 8 * 8);
+        }
+
+        // only needed when L - F + 1 is not a power of two, and so not every bit pattern is a value
+        // bits past the last value must also be 0, to compare equal to the array that was serialized
+        if ((range & (range + 1)) != 0) {
+            if (result.find_unpacked_invalid() != npos) {
+                packed_range::raise("Serialized array holds a value out of range");
+            }
+        }
+
+        if (n * bits % 64 != 0 && (result.words[n * bits / 64] >> (n * bits % 64)) != 0) {
+            packed_range::raise("Serialized array has stray bits past the last value");
+        }
+
+        return result;
+    }
+
+    static Packed_Range_Array deserialize (const std::vector<unsigned char>& data) {
+        return deserialize(data.data(), data.size());
+    }
+
+    friend bool operator== (const Packed_Range_Array& a, const Packed_Range_Array& b) {
+        return a.count == b.count && a.words == b.words;
+    }
+
+    friend bool operator!= (const Packed_Range_Array& a, const Packed_Range_Array& b) {
+        return !(a == b);
+    }
+
+private:
+    // values are checked a block at a time as they are packed, so the block is read once
+    static const std::size_t block = 4096;
+
+    static const std::size_t header_size = 29;
+
+    static constexpr std::uint64_t range = (unsigned long long) L - (unsigned long long) F;
+
+    static constexpr std::uint64_t mask = bits == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << bits) - 1;
+
+    static const bool byte_reads = PACKED_RANGE_LITTLE_ENDIAN && bits <= 57;
+
+    // gathers 4 bytes from the byte holding a value's first bit, which leaves room for 32 - 7 bits
+    static const bool vectorised = sizeof(T) == 4 && bits > 0 && bits <= 25;
+
+    std::vector<std::uint64_t> words;
+    std::size_t count;
+
+    static std::size_t words_for (std::size_t n) {
+        return (n * bits + 63) / 64 + 1;
+    }
+
+    static std::size_t payload_size (std::size_t n) {
+        return (n * bits + 7) / 8;
+    }
+
+    static void write_le (unsigned long long a, unsigned char* p) {
+        for (int k = 0; k < 8; k++) {
+            p[k] = (unsigned char) (a >> (8 * k));
+        }
+    }
+
+    static unsigned long long read_le (const unsigned char* p) {
+        unsigned long long a = 0;
+
+        for (int k = 0; k < 8; k++) {
+            a |= (unsigned long long) p[k] << (8 * k);
+        }
+
+        return a;
+    }
+
+    static std::uint64_t offset_of (T a) {
+        return (std::uint64_t) a - (std::uint64_t) F;
+    }
+
+    static T value_of (std::uint64_t x) {
+        return T((std::uint64_t) F + x);
+    }
+
+    // a value of up to 57 bits is within the 8 bytes from the byte holding its first bit, read in one load,
+    // which needs the words laid out little endian in memory
+    // otherwise the high part is shifted in two steps, so a value starting at bit 0 of a word shifts the next word out
+    std::uint64_t get (std::size_t i) const {
+        if (bits == 0) {
+            return 0;
+        }
+
+        std::size_t pos = i * bits;
+
+        if (byte_reads) {
+            std::uint64_t x;
+            std::memcpy(&x, (const unsigned char*) words.data() + pos / 8, sizeof(x));
+
+            return (x >> (pos % 8)) & mask;
+        }
+
+        std::size_t w = pos / 64;
+        unsigned    s = pos % 64;
+
+        return ((words[w] >> s) | ((words[w + 1] << 1) << (63 - s))) & mask;
+    }
+
+    void put (std::size_t i, std::uint64_t x) {
+        if (bits == 0) {
+            return;
+        }
+
+        std::size_t pos = i * bits;
+        std::size_t w   = pos / 64;
+        unsigned    s   = pos % 64;
+
+        words[w]     = (words[w] & ~(mask << s)) | (x << s);
+        words[w + 1] = (words[w + 1] & ~((mask >> 1) >> (63 - s))) | ((x >> 1) >> (63 - s));
+    }
+
+    // bits of value i are known to be 0
+    void put_new (std::size_t i, std::uint64_t x) {
+        if (bits == 0) {
+            return;
+        }
+
+        std::size_t pos = i * bits;
+        std::size_t w   = pos / 64;
+        unsigned    s   = pos % 64;
+
+        words[w]     |= x << s;
+        words[w + 1] |= (x >> 1) >> (63 - s);
+    }
+
+    void grow (std::size_t n) {
+        this->count += n;
+        words.resize(words_for(this->count));
+    }
+
+    // appends a[0 .. n), and gives false if some value is outside [F, L], in which case what was appended is garbage
+    bool pack (const T* a, std::size_t n) {
+        std::size_t first = this->count;
+        std::size_t k = 0;
+        bool valid = true;
+
+        grow(n);
+
+        for (; k < n && (first + k) % 64 != 0; k++) {
+            valid &= offset_of(a[k]) <= range;
+            put_new(first + k, offset_of(a[k]));
+        }
+
+        for (; k + 64 <= n; k += 64) {
+            valid &= pack_group(a + k, words.data() + (first + k) / 64 * bits);
+        }
+
+        for (; k < n; k++) {
+            valid &= offset_of(a[k]) <= range;
+            put_new(first + k, offset_of(a[k]));
+        }
+
+        return valid;
+    }
+
+    // 64 values fill exactly bits words, gathered into one word at a time and each written once
+    // values are checked first, in a separate loop that vectorises
+    static bool pack_group (const T* a, std::uint64_t* out) {
+        std::uint64_t acc = 0;
+        unsigned s = 0;
+        std::size_t w = 0;
+        bool valid = group_in_range(a);
+
+        PACKED_RANGE_UNROLL
+        for (unsigned k = 0; k < 64; k++) {
+            std::uint64_t x = offset_of(a[k]);
+
+            acc |= x << s;
+            s += bits;
+
+            if (s >= 64) {
+                out[w++] = acc;
+                s -= 64;
+                acc = (x >> 1) >> (bits - 1 - s);
+            }
+        }
+
+        return valid;
+    }
+
+    // a - F wraps around past L - F when a is below F, so one unsigned compare covers both ends
+    static bool group_in_range (const T* a) {
+        using unsigned_T = typename std::make_unsigned<T>::type;
+
+        unsigned_T outside = 0;
+
+        for (unsigned k = 0; k < 64; k++) {
+            outside |= unsigned_T(unsigned_T(unsigned_T(a[k]) - unsigned_T(F)) > unsigned_T(range));
+        }
+
+        return outside == 0;
+    }
+
+    // reads one word past the group, the next group's first or the spare word
+    static void unpack_group (const std::uint64_t* in, T* out) {
+        if (bits == 0) {
+            std::fill(out, out + 64, T(F));
+            return;
+        }
+
+        PACKED_RANGE_UNROLL
+        for (unsigned k = 0; k < 64; k++) {
+            unsigned pos = k * bits;
+            unsigned w   = pos / 64;
+            unsigned s   = pos % 64;
+
+            out[k] = value_of(((in[w] >> s) | ((in[w + 1] << 1) << (63 - s))) & mask);
+        }
+    }
+
+    // index of the first stored value outside [0, L - F], only possible for words not written through pack or put
+    std::size_t find_unpacked_invalid () const {
+        for (std::size_t i = 0; i < this->count; i++) {
+            if (get(i) > range) {
+                return i;
+            }
+        }
+
+        return npos;
+    }
+
+    static Range_Status status_of (T a) {
+        return a < F ? Range_Status::underflow : Range_Status::overflow;
+    }
+
+    std::size_t store (const T* a, std::size_t n) {
+        std::size_t old_size = this->count;
+        std::size_t result   = npos;
+
+        reserve(old_size + n);
+
+        // each block is checked as it is packed, and only dropped and gone over again when it holds a value out of range
+        for (std::size_t i = 0; i < n; i += block) {
+            std::size_t len = n - i < block ? n - i : block;
+            bool valid = pack(a + i, len);
+
+            if (RANGE_TYPE_UNLIKELY(!valid)) {
+                std::size_t bad = i + Range_Vector<T, F, L, Policy>::find_invalid(a + i, len);
+
+                truncate(this->count - len);
+
+                if (result == npos) {
+                    result = bad;
+                }
+
+                if (!on_invalid(a, bad, old_size, Policy())) {
+                    return result;
+                }
+
+                for (std::size_t k = 0; k < len; k++) {
+                    push_back(value_type(fixed(a[i + k], std::integral_constant<bool, Policy::reports_status>()),
+                                         typename value_type::unchecked_tag()));
+                }
+            }
+        }
+
+        return result;
+    }
+
+    // drops values appended from offset on
+    void truncate (std::size_t offset) {
+        this->count = offset;
+        words.resize(words_for(offset));
+
+        if (offset * bits % 64 != 0) {
+            words[offset * bits / 64] &= (std::uint64_t(1) << (offset * bits % 64)) - 1;
+        }
+        words.back() = 0;
+    }
+
+    // true if the policy replaces offending values and storing carries on
+    bool on_invalid (const T* a, std::size_t bad, std::size_t offset, Throw_On_Violation) {
+        truncate(offset);
+        range_vector_error::raise<range_type_error::wide<T>>(bad, F, L, status_of(a[bad]), a[bad]);
+    }
+
+    template <typename P>
+    bool on_invalid (const T*, std::size_t, std::size_t offset, P) {
+        if (P::reports_status) {
+            truncate(offset);
+            return false;
+        }
+
+        return true;
+    }
+
+    static T fixed (T a, std::false_type) {
+        if (a >= F && a <= L) {
+            return a;
+        }
+
+        return Policy::template on_violation<T, F, L>(status_of(a), 0, a, 0);
+    }
+
+    static T fixed (T a, std::true_type) {
+        return a;
+    }
+
+#if PACKED_RANGE_X86
+// GCC reports the _mm512_undefined_epi32 placeholder inside the AVX-512 intrinsics as uninitialised
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+    // 8 values from a multiple of 8 start on a byte boundary,
+    // value k of the group sits (k * bits) / 8 bytes in and (k * bits) % 8 bits up from there
+    __attribute__((target("avx2")))
+    std::size_t decode_avx2 (std::size_t first, std::size_t n, T* out) const {
+        const unsigned char* bytes = (const unsigned char*) words.data();
+        const __m256i step  = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        const __m256i pos   = _mm256_mullo_epi32(step, _mm256_set1_epi32(int(bits)));
+        const __m256i index = _mm256_srli_epi32(pos, 3);
+        const __m256i shift = _mm256_and_si256(pos, _mm256_set1_epi32(7));
+        const __m256i m     = _mm256_set1_epi32(int(mask));
+        const __m256i f     = _mm256_set1_epi32(int(F));
+        std::size_t i = 0;
+
+        for (; i + 8 <= n; i += 8) {
+            const unsigned char* base = bytes + (first + i) * bits / 8;
+            __m256i v = _mm256_i32gather_epi32((const int*) base, index, 1);
+
+            v = _mm256_and_si256(_mm256_srlv_epi32(v, shift), m);
+            _mm256_storeu_si256((__m256i*) (out + i), _mm256_add_epi32(v, f));
+        }
+
+        return i;
+    }
+
+    __attribute__((target("avx512f")))
+    std::size_t decode_avx512 (std::size_t first, std::size_t n, T* out) const {
+        const unsigned char* bytes = (const unsigned char*) words.data();
+        const __m512i step  = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        const __m512i pos   = _mm512_mullo_epi32(step, _mm512_set1_epi32(int(bits)));
+        const __m512i index = _mm512_srli_epi32(pos, 3);
+        const __m512i shift = _mm512_and_si512(pos, _mm512_set1_epi32(7));
+        const __m512i m     = _mm512_set1_epi32(int(mask));
+        const __m512i f     = _mm512_set1_epi32(int(F));
+        std::size_t i = 0;
+
+        for (; i + 16 <= n; i += 16) {
+            const unsigned char* base = bytes + (first + i) * bits / 8;
+            __m512i v = _mm512_i32gather_epi32(index, (const void*) base, 1);
+
+            v = _mm512_and_si512(_mm512_srlv_epi32(v, shift), m);
+            _mm512_storeu_si512((void*) (out + i), _mm512_add_epi32(v, f));
+        }
+
+        return i;
+    }
+
+#pragma GCC diagnostic pop
+#endif
+};
+
+// Random access iterator over the values, dereferences to Range_Type<T, F, L, Policy>
+template <typename T, long long int F, long long int L, typename Policy>
+class Packed_Range_Array<T, F, L, Policy>::const_iterator {
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type        = typename Packed_Range_Array::value_type;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = void;
+    using reference         = value_type;
+
+    const_iterator () : array {nullptr}, pos {0} {}
+
+    const_iterator (const Packed_Range_Array* a, std::size_t i) : array {a}, pos {i} {}
+
+    value_type operator* () const {
+        return (*array)[pos];
+    }
+
+    value_type operator[] (difference_type n) const {
+        return (*array)[pos + n];
+    }
+
+    const_iterator& operator++ () {
+        ++this->pos;
+        return *this;
+    }
+
+    const_iterator operator++ (int) {
+        const_iterator old = *this;
+        ++this->pos;
+        return old;
+    }
+
+    const_iterator& operator-- () {
+        --this->pos;
+        return *this;
+    }
+
+    const_iterator operator-- (int) {
+        const_iterator old = *this;
+        --this->pos;
+        return old;
+    }
+
+    const_iterator& operator+= (difference_type n) {
+        this->pos += n;
+        return *this;
+    }
+
+    const_iterator& operator-= (difference_type n) {
+        this->pos -= n;
+        return *this;
+    }
+
+    friend const_iterator operator+ (const_iterator a, difference_type n) {
+        return a += n;
+    }
+
+    friend const_iterator operator+ (difference_type n, const_iterator a) {
+        return a += n;
+    }
+
+    friend const_iterator operator- (const_iterator a, difference_type n) {
+        return a -= n;
+    }
+
+    friend difference_type operator- (const const_iterator& a, const const_iterator& b) {
+        return difference_type(a.pos - b.pos);
+    }
+
+    friend bool operator== (const const_iterator& a, const const_iterator& b) {
+        return a.pos == b.pos;
+    }
+
+    friend bool operator!= (const const_iterator& a, const const_iterator& b) {
+        return a.pos != b.pos;
+    }
+
+    friend bool operator< (const const_iterator& a, const const_iterator& b) {
+        return a.pos < b.pos;
+    }
+
+    friend bool operator> (const const_iterator& a, const const_iterator& b) {
+        return a.pos > b.pos;
+    }
+
+    friend bool operator<= (const const_iterator& a, const const_iterator& b) {
+        return a.pos <= b.pos;
+    }
+
+    friend bool operator>= (const const_iterator& a, const const_iterator& b) {
+        return a.pos >= b.pos;
+    }
+
+private:
+    const Packed_Range_Array* array;
+    std::size_t pos;
+};
+
+#endif // PACKED_RANGE_ARRAY_H_INCLUDED
@@ -0,0 +1,307 @@
+/* Interval arithmetic on Range_Type values
+ * The bounds of a result are worked out at compile time from the bounds of the operands,
+ * e.g. [0, 100] + [0, 100] gives [0, 200], so no check is needed to compute it
+ * A check is only done when the result bounds go beyond the underlying type, or when converting to a narrower Range_Type
+ *
+ * License:
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include <climits>
+#include <limits>
+#include <ostream>
+#include <type_traits>
+#include "range_type.h"
+
+#ifndef RANGE_INTERVAL_H_INCLUDED
+#define RANGE_INTERVAL_H_INCLUDED
+
+// Bound arithmetic, done on long long int and saturating, so a bound that would not fit ends up at LLONG_MIN or LLONG_MAX
+// A saturated bound is no longer exact, and can equal the limit of a 64 bit T,
+// so the *_saturates functions tell when it happens and the operation is then checked
+namespace range_interval_arith {
+    constexpr bool add_saturates (long long int a, long long int b) {
+        return b > 0 ? a > LLONG_MAX - b : a < LLONG_MIN - b;
+    }
+
+    constexpr bool sub_saturates (long long int a, long long int b) {
+        return b < 0 ? a > LLONG_MAX + b : a < LLONG_MIN + b;
+    }
+
+    constexpr bool mul_saturates (long long int a, long long int b) {
+        return a == 0 || b == 0 ? false
+             : a > 0 && b > 0   ? a > LLONG_MAX / b
+             : a < 0 && b < 0   ? a < LLONG_MAX / b
+             : a > 0            ? b < LLONG_MIN / a
+             :                    a < LLONG_MIN / b;
+    }
+
+    constexpr long long int add (long long int a, long long int b) {
+        return !add_saturates(a, b) ? a + b : b > 0 ? LLONG_MAX : LLONG_MIN;
+    }
+
+    constexpr long long int sub (long long int a, long long int b) {
+        return !sub_saturates(a, b) ? a - b : b < 0 ? LLONG_MAX : LLONG_MIN;
+    }
+
+    constexpr long long int mul (long long int a, long long int b) {
+        return !mul_saturates(a, b) ? a * b : (a < 0) == (b < 0) ? LLONG_MAX : LLONG_MIN;
+    }
+
+    constexpr long long int min (long long int a, long long int b) {
+        return a < b ? a : b;
+    }
+
+    constexpr long long int max (long long int a, long long int b) {
+        return a > b ? a : b;
+    }
+
+    // limits of T as long long int, unsigned long long int is capped at LLONG_MAX like Range_Type bounds are
+    template <typename T>
+    constexpr long long int type_min () {
+        return (long long int) std::numeric_limits<T>::min();
+    }
+
+    template <typename T>
+    constexpr long long int type_max () {
+        return std::numeric_limits<T>::max() > (unsigned long long int) LLONG_MAX ? LLONG_MAX
+                                                                                  : (long long int) std::numeric_limits<T>::max();
+    }
+
+    template <typename T>
+    constexpr long long int clamp (long long int a) {
+        return min(max(a, type_min<T>()), type_max<T>());
+    }
+}
+
+template <typename T, long long int F, long long int L, typename Policy = Throw_On_Violation>
+class Range_Interval;
+
+// Result of an operation whose exact result lies in [RF, RL], or beyond them when Saturated
+// If that goes beyond T, the result is kept to the part of [RF, RL] within T, and the operation is checked
+template <typename T, long long int RF, long long int RL, typename Policy, bool Saturated>
+struct Range_Interval_Result {
+    static const bool checked = Saturated || RF < range_interval_arith::type_min<T>() || RL > range_interval_arith::type_max<T>();
+
+    // each bound is clamped to T, so a result entirely beyond T still gives a valid, if always failing, interval
+    using type = Range_Interval<T,
+                                range_interval_arith::clamp<T>(RF),
+                                range_interval_arith::clamp<T>(RL),
+                                Policy>;
+};
+
+// Value known to be in [F, L], produced by interval(a) from a Range_Type, or by arithmetic on other Range_Interval values
+// Converts to any Range_Type<T, F2, L2, P2>, without a check if [F, L] is within [F2, L2]
+// Policy handles results going beyond T, Status_On_Violation is not supported, use narrow to get a status instead
+template <typename T, long long int F, long long int L, typename Policy>
+class Range_Interval {
+
+    static_assert(std::is_integral<T>::value,
+                  "Type must be integral");
+
+    static_assert(F >= range_interval_arith::type_min<T>() && L <= range_interval_arith::type_max<T>() && F <= L,
+                  "Bounds must be within type and first must not be larger than last");
+
+    static_assert(!Policy::reports_status,
+                  "Range_Interval can not report status, policy must throw, saturate, wrap or trap");
+
+public:
+    template <typename P>
+    RANGE_TYPE_CONSTEXPR Range_Interval (const Range_Type<T, F, L, P>& a) : val {a.value()} {}
+
+    RANGE_TYPE_CONSTEXPR T value () const {
+        return this->val;
+    }
+
+    static constexpr long long int first () {
+        return F;
+    }
+
+    static constexpr long long int last () {
+        return L;
+    }
+
+    // narrowing conversion, checked with P2 unless [F, L] is within [F2, L2]
+    template <long long int F2, long long int L2, typename P2>
+    RANGE_TYPE_CONSTEXPR operator Range_Type<T, F2, L2, P2> () const {
+        return convert<F2, L2, P2>(std::integral_constant<bool, (F2 <= F && L <= L2)>());
+    }
+
+    // R::make on the value, so under Status_On_Violation the status can be seen
+    template <typename R>
+    RANGE_TYPE_CONSTEXPR typename R::result_type narrow () const {
+        return R::make(val);
+    }
+
+    friend std::ostream& operator<< (std::ostream& out, const Range_Interval& a) {
+        out << +a.val;
+        return out;
+    }
+
+    template <long long int F2, long long int L2>
+    friend RANGE_TYPE_CONSTEXPR bool operator== (const Range_Interval& a, const Range_Interval<T, F2, L2, Policy>& b) {
+        return a.val == b.value();
+    }
+
+    template <long long int F2, long long int L2>
+    friend RANGE_TYPE_CONSTEXPR bool operator!= (const Range_Interval& a, const Range_Interval<T, F2, L2, Policy>& b) {
+        return a.val != b.value();
+    }
+
+    template <long long int F2, long long int L2>
+    using sum = Range_Interval_Result<T, range_interval_arith::add(F, F2), range_interval_arith::add(L, L2), Policy,
+                                      range_interval_arith::add_saturates(F, F2) || range_interval_arith::add_saturates(L, L2)>;
+
+    template <long long int F2, long long int L2>
+    using difference = Range_Interval_Result<T, range_interval_arith::sub(F, L2), range_interval_arith::sub(L, F2), Policy,
+                                             range_interval_arith::sub_saturates(F, L2) || range_interval_arith::sub_saturates(L, F2)>;
+
+    template <long long int F2, long long int L2>
+    using product = Range_Interval_Result<T,
+                                          range_interval_arith::min(range_interval_arith::min(range_interval_arith::mul(F, F2), range_interval_arith::mul(F, L2)),
+                                                                    range_interval_arith::min(range_interval_arith::mul(L, F2), range_interval_arith::mul(L, L2))),
+                                          range_interval_arith::max(range_interval_arith::max(range_interval_arith::mul(F, F2), range_interval_arith::mul(F, L2)),
+                                                                    range_interval_arith::max(range_interval_arith::mul(L, F2), range_interval_arith::mul(L, L2))),
+                                          Policy,
+                                          range_interval_arith::mul_saturates(F, F2) || range_interval_arith::mul_saturates(F, L2) ||
+                                          range_interval_arith::mul_saturates(L, F2) || range_interval_arith::mul_saturates(L, L2)>;
+
+    template <long long int F2, long long int L2>
+    friend RANGE_TYPE_CONSTEXPR typename sum<F2, L2>::type operator+ (const Range_Interval& a, const Range_Interval<T, F2, L2, Policy>& b) {
+        return combine<sum<F2, L2>>('+', a.val, b.value());
+    }
+
+    template <long long int F2, long long int L2>
+    friend RANGE_TYPE_CONSTEXPR typename difference<F2, L2>::type operator- (const Range_Interval& a, const Range_Interval<T, F2, L2, Policy>& b) {
+        return combine<difference<F2, L2>>('-', a.val, b.value());
+    }
+
+    template <long long int F2, long long int L2>
+    friend RANGE_TYPE_CONSTEXPR typename product<F2, L2>::type operator* (const Range_Interval& a, const Range_Interval<T, F2, L2, Policy>& b) {
+        return combine<product<F2, L2>>('*', a.val, b.value());
+    }
+
+    // a Range_Type operand takes part with its own bounds
+    template <long long int F2, long long int L2, typename P2>
+    friend RANGE_TYPE_CONSTEXPR typename sum<F2, L2>::type operator+ (const Range_Interval& a, const Range_Type<T, F2, L2, P2>& b) {
+        return a + Range_Interval<T, F2, L2, Policy>(b);
+    }
+
+    template <long long int F2, long long int L2, typename P2>
+    friend RANGE_TYPE_CONSTEXPR typename difference<F2, L2>::type operator- (const Range_Interval& a, const Range_Type<T, F2, L2, P2>& b) {
+        return a - Range_Interval<T, F2, L2, Policy>(b);
+    }
+
+    template <long long int F2, long long int L2, typename P2>
+    friend RANGE_TYPE_CONSTEXPR typename product<F2, L2>::type operator* (const Range_Interval& a, const Range_Type<T, F2, L2, P2>& b) {
+        return a * Range_Interval<T, F2, L2, Policy>(b);
+    }
+
+    // and on the left, where these are exact matches ahead of Range_Type's own operators through the conversion above
+    template <long long int F2, long long int L2, typename P2>
+    friend RANGE_TYPE_CONSTEXPR typename Range_Interval<T, F2, L2, Policy>::template sum<F, L>::type
+    operator+ (const Range_Type<T, F2, L2, P2>& a, const Range_Interval& b) {
+        return Range_Interval<T, F2, L2, Policy>(a) + b;
+    }
+
+    template <long long int F2, long long int L2, typename P2>
+    friend RANGE_TYPE_CONSTEXPR typename Range_Interval<T, F2, L2, Policy>::template difference<F, L>::type
+    operator- (const Range_Type<T, F2, L2, P2>& a, const Range_Interval& b) {
+        return Range_Interval<T, F2, L2, Policy>(a) - b;
+    }
+
+    template <long long int F2, long long int L2, typename P2>
+    friend RANGE_TYPE_CONSTEXPR typename Range_Interval<T, F2, L2, Policy>::template product<F, L>::type
+    operator* (const Range_Type<T, F2, L2, P2>& a, const Range_Interval& b) {
+        return Range_Interval<T, F2, L2, Policy>(a) * b;
+    }
+
+private:
+    template <typename, long long int, long long int, typename> friend class Range_Interval;
+
+    T val;
+
+    struct unchecked_tag {};
+
+    RANGE_TYPE_CONSTEXPR Range_Interval (T a, unchecked_tag) : val {a} {}
+
+    // other specialisations are friends of this class, but not of its friend operators
+    template <typename R>
+    static RANGE_TYPE_CONSTEXPR typename R::type combine (char op, T a, T b) {
+        return R::type::template apply<R::checked>(op, a, b);
+    }
+
+    // a op b, where the result is known to be in [F, L] unless checked
+    template <bool checked>
+    static RANGE_TYPE_CONSTEXPR Range_Interval apply (char op, T a, T b) {
+        return apply(op, a, b, std::integral_constant<bool, checked>());
+    }
+
+    static RANGE_TYPE_CONSTEXPR Range_Interval apply (char op, T a, T b, std::false_type) {
+        return Range_Interval(op == '+' ? T(a + b) : op == '-' ? T(a - b) : T(a * b), unchecked_tag());
+    }
+
+    static RANGE_TYPE_CONSTEXPR Range_Interval apply (char op, T a, T b, std::true_type) {
+        T r = 0;
+        bool fits = op == '+' ? range_type_arith::add(a, b, r)
+                  : op == '-' ? range_type_arith::sub(a, b, r)
+                  :             range_type_arith::mul(a, b, r);
+
+        // [F, L] covers every in-type result on at least one side, the other side is checked here
+        if (RANGE_TYPE_UNLIKELY(!fits || r < F || r > L)) {
+            return Range_Interval(Policy::template on_violation<T, F, L>(status_of(op, a, b, fits, r), op, a, b), unchecked_tag());
+        }
+
+        return Range_Interval(r, unchecked_tag());
+    }
+
+    static RANGE_TYPE_CONSTEXPR Range_Status status_of (char op, T a, T b, bool fits, T r) {
+        return fits        ? (r < F ? Range_Status::underflow : Range_Status::overflow)
+             : op == '+'   ? (b < 0 ? Range_Status::underflow : Range_Status::overflow)
+             : op == '-'   ? (b < 0 ? Range_Status::overflow : Range_Status::underflow)
+             :               ((a < 0) != (b < 0) ? Range_Status::underflow : Range_Status::overflow);
+    }
+
+    template <long long int F2, long long int L2, typename P2>
+    RANGE_TYPE_CONSTEXPR Range_Type<T, F2, L2, P2> convert (std::true_type) const {
+        return Range_Type<T, F2, L2, P2>(val, typename Range_Type<T, F2, L2, P2>::unchecked_tag());
+    }
+
+    template <long long int F2, long long int L2, typename P2>
+    RANGE_TYPE_CONSTEXPR Range_Type<T, F2, L2, P2> convert (std::false_type) const {
+        return Range_Type<T, F2, L2, P2>(val);
+    }
+};
+
+// opts a Range_Type value into interval arithmetic
+// Policy of the result is that of a, apart from Status_On_Violation which becomes Throw_On_Violation
+template <typename T, long long int F, long long int L, typename P>
+RANGE_TYPE_CONSTEXPR Range_Interval<T, F, L, typename std::conditional<P::reports_status, Throw_On_Violation, P>::type>
+interval (const Range_Type<T, F, L, P>& a) {
+    return Range_Interval<T, F, L, typename std::conditional<P::reports_status, Throw_On_Violation, P>::type>(a);
+}
+
+#endif // RANGE_INTERVAL_H_INCLUDED
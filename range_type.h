@@ -31,595 +31,1048 @@
  * For more information, please refer to <http://unlicense.org/>
  */
 
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
+#include <iterator>
+#include <limits>
 #include <ostream>
 #include <string>
 #include <sstream>
 #include <stdexcept>
+#include <type_traits>
 #include "mod_type.h"
 
-#ifndef RANGE_TYPE_H_INCLUDED
+#ifndef RANGE_TYPE_H_INCLUDED
 #define RANGE_TYPE_H_INCLUDED
 
 class RangeTypeException : public std::runtime_error {
 public:
     RangeTypeException (std::string errMsg) : runtime_error(errMsg) {}
 private:
-};
-
-template <typename T, long long int F, long long int L>
-class Range_Type : public std::iterator<std::random_access_iterator_tag,
-                                        T,
-                                        T,
-                                        const T*,
-                                        T
-                                       >
-{
+};
 
-    static_assert(std::is_integral<T>::value,
-                  "Type must be integral");
+#if defined(__GNUC__)
+#define RANGE_TYPE_COLD         __attribute__((noinline, cold))
+#define RANGE_TYPE_UNLIKELY(x)  __builtin_expect(!!(x), 0)
+#elif defined(_MSC_VER)
+#define RANGE_TYPE_COLD         __declspec(noinline)
+#define RANGE_TYPE_UNLIKELY(x)  (x)
+#else
+#define RANGE_TYPE_COLD
+#define RANGE_TYPE_UNLIKELY(x)  (x)
+#endif
+
+// operations are usable in constant expressions from C++14 onwards
+// a range violation during constant evaluation is a compile error, unless the policy gives a replacement value
+#if __cplusplus >= 201402L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201402L)
+#define RANGE_TYPE_CONSTEXPR constexpr
+#else
+#define RANGE_TYPE_CONSTEXPR
+#endif
+
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define RANGE_TYPE_EXCEPTIONS 1
+#else
+#define RANGE_TYPE_EXCEPTIONS 0
+#endif
+
+// may be defined to 0 beforehand to use the portable checks
+#ifndef RANGE_TYPE_OVERFLOW_BUILTINS
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_add_overflow) && __has_builtin(__builtin_sub_overflow) && __has_builtin(__builtin_mul_overflow)
+#define RANGE_TYPE_OVERFLOW_BUILTINS 1
+#endif
+#endif
+#endif
+#if !defined(RANGE_TYPE_OVERFLOW_BUILTINS) && defined(__GNUC__) && __GNUC__ >= 5
+#define RANGE_TYPE_OVERFLOW_BUILTINS 1
+#endif
+#ifndef RANGE_TYPE_OVERFLOW_BUILTINS
+#define RANGE_TYPE_OVERFLOW_BUILTINS 0
+#endif
+
+// may be defined to 0 beforehand to store every Range_Type<T, F, L> as a full T
+#ifndef RANGE_TYPE_COMPACT
+#define RANGE_TYPE_COMPACT 1
+#endif
+
+// Overflow checked arithmetic on T
+// Each function gives false if the exact result of a op b does not fit in T, r is only written otherwise
+// Uses the compiler's overflow builtins where available, then a double width type, then plain limit checks
+namespace range_type_arith {
+#if RANGE_TYPE_OVERFLOW_BUILTINS
+    template <typename T>
+    RANGE_TYPE_CONSTEXPR bool add (T a, T b, T& r) {
+        return !__builtin_add_overflow(a, b, &r);
+    }
 
-    static_assert(F >= std::numeric_limits<T>::min(),
-                  "First is smaller than type minimum possible value");
+    template <typename T>
+    RANGE_TYPE_CONSTEXPR bool sub (T a, T b, T& r) {
+        return !__builtin_sub_overflow(a, b, &r);
+    }
 
-    static_assert(L <= std::numeric_limits<T>::max(),
-                  "Last exceeds type maximum possible value");
+    template <typename T>
+    RANGE_TYPE_CONSTEXPR bool mul (T a, T b, T& r) {
+        return !__builtin_mul_overflow(a, b, &r);
+    }
+#else
+    // long long int holds any sum, difference or product of two values of a narrower type
+    template <typename T>
+    using has_wide = std::integral_constant<bool, (sizeof(T) < sizeof(long long int))>;
+
+    template <typename T>
+    RANGE_TYPE_CONSTEXPR bool fit (long long int w, T& r) {
+        if (w < (long long int) std::numeric_limits<T>::min() || w > (long long int) std::numeric_limits<T>::max()) {
+            return false;
+        }
 
-    static_assert(F <= L,
-                  "First is larger than last");
+        r = T(w);
+        return true;
+    }
 
-private:
-    using rand_iterator = std::iterator<std::random_access_iterator_tag, T, T, const T*, T>;
+    template <typename T>
+    RANGE_TYPE_CONSTEXPR bool add (T a, T b, T& r, std::true_type) {
+        return fit<T>((long long int) a + (long long int) b, r);
+    }
 
-public:
-    // iterator functions
-    static Range_Type begin () {
-        return Range_Type(F);
+    template <typename T>
+    RANGE_TYPE_CONSTEXPR bool add (T a, T b, T& r, std::false_type) {
+        if (b >= 0 ? a > std::numeric_limits<T>::max() - b
+                   : a < std::numeric_limits<T>::min() - b) {
+            return false;
+        }
+
+        r = a + b;
+        return true;
     }
 
-    static Range_Type end () {
-        return Range_Type(L);
+    template <typename T>
+    RANGE_TYPE_CONSTEXPR bool sub (T a, T b, T& r, std::true_type) {
+        return fit<T>((long long int) a - (long long int) b, r);
     }
 
-    typename rand_iterator::reference operator* () const {
-        return val;
+    template <typename T>
+    RANGE_TYPE_CONSTEXPR bool sub (T a, T b, T& r, std::false_type) {
+        if (b >= 0 ? a < std::numeric_limits<T>::min() + b
+                   : a > std::numeric_limits<T>::max() + b) {
+            return false;
+        }
+
+        r = a - b;
+        return true;
     }
 
-    // class constructors and other functions
-    Range_Type () : val {F} {}
+    template <typename T>
+    RANGE_TYPE_CONSTEXPR bool mul (T a, T b, T& r, std::true_type) {
+        return fit<T>((long long int) a * (long long int) b, r);
+    }
 
-    Range_Type (T a) : val {val_check(a)} {}
+    template <typename T>
+    RANGE_TYPE_CONSTEXPR bool mul (T a, T b, T& r, std::false_type) {
+        const T max = std::numeric_limits<T>::max();
+        const T min = std::numeric_limits<T>::min();
 
-    Range_Type (const Range_Type& a) : val {val_check(a.val)} {};
+        if (a != 0 && b != 0) {
+            if (a > 0) {
+                if (b > 0 ? a > max / b : b < min / a) {
+                    return false;
+                }
+            }
+            else {
+                if (b > 0 ? a < min / b : b < max / a) {
+                    return false;
+                }
+            }
+        }
 
-    Range_Type operator= (const Range_Type& a) {
-        this->val = val_check(a.val);
-        return *this;
+        r = a * b;
+        return true;
     }
 
-    Range_Type operator= (const T& a) {
-        this->val = val_check(a);
-        return *this;
+    template <typename T>
+    RANGE_TYPE_CONSTEXPR bool add (T a, T b, T& r) {
+        return add(a, b, r, has_wide<T>());
     }
 
-    operator T () const {
-        return val;
+    template <typename T>
+    RANGE_TYPE_CONSTEXPR bool sub (T a, T b, T& r) {
+        return sub(a, b, r, has_wide<T>());
     }
 
-    template<typename ANY_T>
-    operator ANY_T () const = delete;
+    template <typename T>
+    RANGE_TYPE_CONSTEXPR bool mul (T a, T b, T& r) {
+        return mul(a, b, r, has_wide<T>());
+    }
+#endif
+}
+
+// Outcome of a range checked operation
+enum class Range_Status {
+    ok,
+    overflow,   // result would be greater than last value
+    underflow   // result would be smaller than first value
+};
+
+// Error message formatting for Range_Type
+// These are only reached when an operation fails, and are kept out of line so the
+// success path never builds a stream. Values are widened to long long or
+// unsigned long long, so all instantiations share the same two copies of this code
+namespace range_type_error {
+    template <typename T>
+    using wide = typename std::conditional<std::is_signed<T>::value,
+                                           long long int,
+                                           unsigned long long int
+                                          >::type;
+
+    // op is one of '+', '-', '*', or 0 for a plain value check of a
+    //
+    // Range : [ first, last ]    Goal : a
+    // Range : [ first, last ]    Operation : a op b
+    // negative b is put in brackets for + and -, e.g. -1 + (-2147483648)
+    template <typename W>
+    RANGE_TYPE_COLD
+    std::string format (W first, W last, Range_Status status, char op, W a, W b) {
+        std::ostringstream error_message;
+        bool overflow = status == Range_Status::overflow;
+
+        error_message << "Range : [ " << first << ", " << last << " ]    ";
+
+        if (op == 0) {
+            error_message << "Goal : " << a << std::endl;
+            error_message << (overflow ? "Value is greater than largest possible value"
+                                       : "Value is lower than smallest possible value");
+            return error_message.str();
+        }
+
+        error_message << "Operation : " << a << " " << op << " ";
+        if (op != '*' && b < 0) {
+            error_message << "(" << b << ")";
+        }
+        else {
+            error_message << b;
+        }
+        error_message << std::endl;
+
+        switch (op) {
+            case '+' : error_message << "Addition";       break;
+            case '-' : error_message << "Subtraction";    break;
+            default  : error_message << "Multiplication"; break;
+        }
+        error_message << (overflow ? " causes overflow" : " causes underflow");
 
-    T value () const {
-        return this->val;
+        return error_message.str();
     }
 
-    T first () const {
-        return this->lower_limit;
+    template <typename W>
+    [[noreturn]] RANGE_TYPE_COLD
+    void raise (W first, W last, Range_Status status, char op, W a, W b) {
+#if RANGE_TYPE_EXCEPTIONS
+        throw RangeTypeException(format<W>(first, last, status, op, a, b));
+#else
+        std::fputs(format<W>(first, last, status, op, a, b).c_str(), stderr);
+        std::fputc('\n', stderr);
+        std::abort();
+#endif
+    }
+}
+
+// Violation policies
+// Selects what a Range_Type does when a value or an operation falls outside [F, L]
+//
+// A policy with reports_status == false provides
+//     template <typename T, long long int F, long long int L>
+//     static T on_violation (Range_Status status, char op, T a, T b);
+// which is handed the failing a op b (op is 0 for a plain value check of a),
+// and gives the value to use in place of the result, or does not return
+// as well as
+//     template <typename T>
+//     static T on_violation (Range_Status status, char op, T a, T b, T first, T last);
+// which does the same for a range [first, last] only known at runtime
+//
+// A policy with reports_status == true has the operations return Range_Result instead,
+// with the value left unchanged on failure
+
+// throws RangeTypeException, this is the default
+// without exception support the message is written to stderr and the program aborts
+struct Throw_On_Violation {
+    static const bool reports_status = false;
+
+    template <typename T, long long int F, long long int L>
+    [[noreturn]] static T on_violation (Range_Status status, char op, T a, T b) {
+        range_type_error::raise<range_type_error::wide<T>>(F, L, status, op, a, b);
     }
 
-    T last () const {
-        return this->upper_limit;
+    template <typename T>
+    [[noreturn]] static T on_violation (Range_Status status, char op, T a, T b, T first, T last) {
+        range_type_error::raise<range_type_error::wide<T>>(first, last, status, op, a, b);
     }
+};
 
-    T size () const {
-        return this->upper_limit - this->lower_limit + 1;
+// clamps to F on underflow and to L on overflow
+struct Saturate_On_Violation {
+    static const bool reports_status = false;
+
+    template <typename T, long long int F, long long int L>
+    static RANGE_TYPE_CONSTEXPR T on_violation (Range_Status status, char, T, T) {
+        return status == Range_Status::overflow ? T(L) : T(F);
     }
 
-    friend std::ostream& operator<< (std::ostream& out, const Range_Type& a) {
-        out << +a.val;
-        return out;
+    template <typename T>
+    static RANGE_TYPE_CONSTEXPR T on_violation (Range_Status status, char, T, T, T first, T last) {
+        return status == Range_Status::overflow ? last : first;
     }
+};
 
-    Range_Type operator+ () const {
-        return *this;
+// wraps around within [F, L], as if the range were Mod_Type<T, L - F + 1> offset by F
+struct Wrap_On_Violation {
+    static const bool reports_status = false;
+
+    template <typename T, long long int F, long long int L>
+    static RANGE_TYPE_CONSTEXPR T on_violation (Range_Status status, char op, T a, T b) {
+        return on_violation<T>(status, op, a, b, T(F), T(L));
     }
 
-    Range_Type operator- () const {
-        return val_check(-val);
+    template <typename T>
+    static RANGE_TYPE_CONSTEXPR T on_violation (Range_Status, char op, T a, T b, T first, T last) {
+        using U = typename std::make_unsigned<T>::type;
+        using P = typename std::common_type<U, unsigned int>::type;   // avoids promotion to int
+
+        const U size = U(U(last) - U(first) + 1u);
+
+        if (size == 0) {    // range covers the whole type, so use native wrap around
+            switch (op) {
+                case '+' : return T(U(P(a) + P(b)));
+                case '-' : return T(U(P(a) - P(b)));
+                case '*' : return T(U(P(a) * P(b)));
+                default  : return a;
+            }
+        }
+
+        U mod_a = reduce<T, U>(a, size);
+        U mod_b = reduce<T, U>(b, size);
+        U mod_r = 0;
+
+        switch (op) {
+            case '+' : mod_r = add_mod<U>(mod_a, mod_b, size);                        break;
+            case '-' : mod_r = add_mod<U>(mod_a, U(size - mod_b) % size, size);       break;
+            case '*' : mod_r = mul_mod<U>(mod_a, mod_b, size);                        break;
+            default  : mod_r = mod_a;                                                  break;
+        }
+
+        // offset from first
+        U offset = add_mod<U>(mod_r, U(size - reduce<T, U>(first, size)) % size, size);
+
+        return T(U(U(first) + offset));
     }
 
-    friend Range_Type operator+ (const Range_Type& a, const Range_Type& b) {
-        return a.val_add(a.val, b.val);
+private:
+    // a mod size, in [0, size)
+    template <typename T, typename U>
+    static RANGE_TYPE_CONSTEXPR U reduce (T a, U size) {
+        if (a >= 0) {
+            return U(a) % size;
+        }
+
+        // -(a + 1) can always be negated safely
+        return U(size - 1u - U(-(a + 1)) % size);
     }
 
-    friend Range_Type operator+ (const Range_Type& a, const T& b) {
-        return a.val_add(a.val, b);
+    // a, b are in [0, size)
+    template <typename U>
+    static RANGE_TYPE_CONSTEXPR U add_mod (U a, U b, U size) {
+        return a >= U(size - b) ? U(a - U(size - b)) : U(a + b);
     }
 
-    friend Range_Type operator+ (const T& b, const Range_Type& a) {
-        return a.val_add(b,     a.val);
+    template <typename U>
+    static RANGE_TYPE_CONSTEXPR U mul_mod (U a, U b, U size) {
+        U acc = 0;
+
+        // double and add, so no intermediate value exceeds size * 2
+        while (b != 0) {
+            if (b & 1u) {
+                acc = add_mod<U>(acc, a, size);
+            }
+            a = add_mod<U>(a, a, size);
+            b >>= 1;
+        }
+
+        return acc;
     }
+};
 
-    friend Range_Type operator- (const Range_Type& a, const Range_Type& b) {
-        return a.val_sub(a.val, b.val);
+// operations return Range_Result, carrying the status alongside the value
+struct Status_On_Violation {
+    static const bool reports_status = true;
+};
+
+// executes a trapping instruction, for builds where unwinding is not available or not wanted
+struct Trap_On_Violation {
+    static const bool reports_status = false;
+
+    template <typename T, long long int F, long long int L>
+    [[noreturn]] static T on_violation (Range_Status, char, T, T) {
+        trap();
     }
 
-    friend Range_Type operator- (const Range_Type& a, const T& b) {
-        return a.val_sub(a.val, b);
+    template <typename T>
+    [[noreturn]] static T on_violation (Range_Status, char, T, T, T, T) {
+        trap();
     }
 
-    friend Range_Type operator- (const T& b, const Range_Type& a) {
-        return a.val_sub(b,     a.val);
+private:
+    [[noreturn]] static void trap () {
+#if defined(__GNUC__)
+        __builtin_trap();
+#else
+        std::abort();
+#endif
     }
+};
+
+#if CHECK_STATS || RANGE_PROFILE
+// policy named in check statistics and range profiles, as instantiations differing only in policy are counted apart
+namespace range_type_stats {
+    template <typename Policy>
+    struct Policy_Name {
+        static std::string get () {
+            return "custom policy";
+        }
+    };
+
+    template <>
+    struct Policy_Name<Throw_On_Violation> {
+        static std::string get () {
+            return "Throw_On_Violation";
+        }
+    };
+
+    template <>
+    struct Policy_Name<Saturate_On_Violation> {
+        static std::string get () {
+            return "Saturate_On_Violation";
+        }
+    };
+
+    template <>
+    struct Policy_Name<Wrap_On_Violation> {
+        static std::string get () {
+            return "Wrap_On_Violation";
+        }
+    };
+
+    template <>
+    struct Policy_Name<Status_On_Violation> {
+        static std::string get () {
+            return "Status_On_Violation";
+        }
+    };
+
+    template <>
+    struct Policy_Name<Trap_On_Violation> {
+        static std::string get () {
+            return "Trap_On_Violation";
+        }
+    };
 
-    friend Range_Type operator* (const Range_Type& a, const Range_Type& b) {
-        return a.val_mul(a.val, b.val);
+    template <typename Policy>
+    std::string policy_name () {
+        return Policy_Name<Policy>::get();
     }
+}
+#endif
+
+// expected-style result of a Range_Type operation under Status_On_Violation
+// if the operation failed, value() gives the value that was left in place
+template <typename R>
+class Range_Result {
+public:
+    RANGE_TYPE_CONSTEXPR Range_Result (R value, Range_Status status) : res_value {value}, res_status {status} {}
 
-    friend Range_Type operator* (const Range_Type& a, const T& b) {
-        return a.val_mul(a.val, b);
+    RANGE_TYPE_CONSTEXPR R value () const {
+        return this->res_value;
     }
 
-    friend Range_Type operator* (const T& b, const Range_Type& a) {
-        return a.val_mul(b,     a.val);
+    RANGE_TYPE_CONSTEXPR Range_Status status () const {
+        return this->res_status;
     }
 
-    Range_Type operator++ () {
-        return (*this) += 1;
+    RANGE_TYPE_CONSTEXPR bool ok () const {
+        return this->res_status == Range_Status::ok;
     }
 
-    Range_Type operator++ (int) {
-        T ret = val;
-        (*this) += 1;
-        return ret;
+    explicit RANGE_TYPE_CONSTEXPR operator bool () const {
+        return ok();
     }
 
-    Range_Type operator-- () {
-        return (*this) -= 1;
+private:
+    R res_value;
+    Range_Status res_status;
+};
+
+// Random access iterator over the values of [F, L], dereferences to T
+// Position is kept as an offset from F, so end is one past L even where L is the largest value of T
+// Moving the iterator is not checked, an iterator only stays valid between begin and end
+template <typename T, long long int F, long long int L>
+class Range_Iterator {
+
+    static_assert((unsigned long long) L - (unsigned long long) F < ULLONG_MAX,
+                  "Range is too large to iterate over");
+
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using iterator_concept  = std::random_access_iterator_tag;
+    using value_type        = T;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = void;
+    using reference         = T;
+
+    RANGE_TYPE_CONSTEXPR Range_Iterator () : pos {0} {}
+
+    // offset from F, in [0, L - F + 1]
+    explicit RANGE_TYPE_CONSTEXPR Range_Iterator (unsigned long long offset) : pos {offset} {}
+
+    RANGE_TYPE_CONSTEXPR T operator* () const {
+        return T((unsigned long long) F + pos);
     }
 
-    Range_Type operator-- (int) {
-        T ret = val;
-        (*this) -= 1;
-        return ret;
+    RANGE_TYPE_CONSTEXPR T operator[] (difference_type n) const {
+        return *(*this + n);
     }
 
-    Range_Type operator+= (const Range_Type& a) {
-        this->val = val_add(this->val, a.val);
+    RANGE_TYPE_CONSTEXPR Range_Iterator& operator++ () {
+        ++this->pos;
         return *this;
     }
 
-    Range_Type operator+= (const T& a) {
-        this->val = val_add(val, a);
-        return *this;
+    RANGE_TYPE_CONSTEXPR Range_Iterator operator++ (int) {
+        Range_Iterator old = *this;
+        ++this->pos;
+        return old;
     }
 
-    Range_Type operator-= (const Range_Type& a) {
-        this->val = val_sub(this->val, a.val);
+    RANGE_TYPE_CONSTEXPR Range_Iterator& operator-- () {
+        --this->pos;
         return *this;
     }
 
-    Range_Type operator-= (const T& a) {
-        this->val = val_sub(val, a);
-        return *this;
+    RANGE_TYPE_CONSTEXPR Range_Iterator operator-- (int) {
+        Range_Iterator old = *this;
+        --this->pos;
+        return old;
     }
 
-    Range_Type operator*= (const Range_Type& a) {
-        this->val = val_mul(this->val, a.val);
+    RANGE_TYPE_CONSTEXPR Range_Iterator& operator+= (difference_type n) {
+        this->pos += (unsigned long long) n;
         return *this;
     }
 
-    Range_Type operator*= (const T& a) {
-        this->val = val_mul(val, a);
+    RANGE_TYPE_CONSTEXPR Range_Iterator& operator-= (difference_type n) {
+        this->pos -= (unsigned long long) n;
         return *this;
     }
 
-    friend bool operator== (const Range_Type& a, const Range_Type& b) {
-        return a.val == b.val;
+    friend RANGE_TYPE_CONSTEXPR Range_Iterator operator+ (Range_Iterator a, difference_type n) {
+        return a += n;
+    }
+
+    friend RANGE_TYPE_CONSTEXPR Range_Iterator operator+ (difference_type n, Range_Iterator a) {
+        return a += n;
+    }
+
+    friend RANGE_TYPE_CONSTEXPR Range_Iterator operator- (Range_Iterator a, difference_type n) {
+        return a -= n;
+    }
+
+    friend constexpr difference_type operator- (const Range_Iterator& a, const Range_Iterator& b) {
+        return difference_type(a.pos - b.pos);
+    }
+
+    friend constexpr bool operator== (const Range_Iterator& a, const Range_Iterator& b) {
+        return a.pos == b.pos;
+    }
+
+    friend constexpr bool operator!= (const Range_Iterator& a, const Range_Iterator& b) {
+        return a.pos != b.pos;
+    }
+
+    friend constexpr bool operator< (const Range_Iterator& a, const Range_Iterator& b) {
+        return a.pos < b.pos;
+    }
+
+    friend constexpr bool operator> (const Range_Iterator& a, const Range_Iterator& b) {
+        return a.pos > b.pos;
     }
 
-    friend bool operator!= (const Range_Type& a, const Range_Type& b) {
-        return a.val != b.val;
+    friend constexpr bool operator<= (const Range_Iterator& a, const Range_Iterator& b) {
+        return a.pos <= b.pos;
+    }
+
+    friend constexpr bool operator>= (const Range_Iterator& a, const Range_Iterator& b) {
+        return a.pos >= b.pos;
     }
 
 private:
-    // Spill_Proof is for internal use only
-    // it still overflows/underflows but only when the value is outside the range [-T_max^T_max, T_max^T_max]
-    // T_max is maximum possible value of type, ^ used above is power notation rather than bitwise XOR operation
-    class Spill_Proof {
-    private:
-        static const T T_max = std::numeric_limits<T>::max();
-
-    public:
-        Spill_Proof ()      : multiplier {0}, remainder {0} {}
-
-        Spill_Proof (T val) : multiplier {0} {
-            multiplier = val / T_max;
-            remainder = val;
-        }
+    unsigned long long pos;
+};
 
-        Spill_Proof (const Spill_Proof& val) : multiplier {val.multiplier},
-                                               remainder {val.remainder} {}
+// All values of [F, L] in order, holds no state
+// A view under C++20, so usable with std::ranges algorithms and views
+template <typename T, long long int F, long long int L>
+class Range_Values {
+public:
+    using iterator = Range_Iterator<T, F, L>;
 
-        Spill_Proof operator= (const Spill_Proof& a) {
-            this->multiplier = a.multiplier;
-            this->remainder  = a.remainder;
+    static RANGE_TYPE_CONSTEXPR iterator begin () {
+        return iterator(0);
+    }
 
-            return *this;
-        }
+    static RANGE_TYPE_CONSTEXPR iterator end () {
+        return iterator(size());
+    }
 
-        Spill_Proof operator= (const T a) {
-            *this = Spill_Proof(a);
+    static constexpr unsigned long long size () {
+        return (unsigned long long) L - (unsigned long long) F + 1;
+    }
+};
 
-            return *this;
-        }
+// Smallest integer type holding every value of [F, L], tried in order of size
+//     the value as it is, in a signed or unsigned type of that size
+//     the value - F, in an unsigned type of that size
+// T itself when no type smaller than T does
+namespace range_type_storage {
+    template <std::size_t Size> struct Sized;
+    template <> struct Sized<1> { using signed_type = std::int8_t;  using unsigned_type = std::uint8_t;  };
+    template <> struct Sized<2> { using signed_type = std::int16_t; using unsigned_type = std::uint16_t; };
+    template <> struct Sized<4> { using signed_type = std::int32_t; using unsigned_type = std::uint32_t; };
+    template <> struct Sized<8> { using signed_type = std::int64_t; using unsigned_type = std::uint64_t; };
+
+    template <typename S>
+    constexpr bool holds (long long int first, long long int last) {
+        return first >= (long long int) std::numeric_limits<S>::min() && last <= (long long int) std::numeric_limits<S>::max();
+    }
 
-        friend std::ostream& operator<< (std::ostream& out, const Spill_Proof& a) {
-            out << +T_max << " * " << +a.multiplier << " + " << +a.remainder;
-            return out;
-        }
+    template <typename T, long long int F, long long int L, std::size_t Size = 1, bool Smaller = (Size < sizeof(T))>
+    struct Storage {
+        using S = typename Sized<Size>::signed_type;
+        using U = typename Sized<Size>::unsigned_type;
+        using next = Storage<T, F, L, Size * 2>;
 
-        friend Spill_Proof operator+ (const Spill_Proof& a, const Spill_Proof& b) {
-            Spill_Proof result;
+        static const bool as_is       = holds<S>(F, L) || holds<U>(F, L);
+        static const bool offset_fits = (unsigned long long) L - (unsigned long long) F <= std::numeric_limits<U>::max();
 
-            result.multiplier = a.multiplier + b.multiplier;
-            result.remainder  = a.remainder;
-            if (T_max - result.remainder.value() < b.remainder.value()) {
-                result.multiplier++;
-            }
-            result.remainder += b.remainder;
+        using type = typename std::conditional<holds<S>(F, L), S,
+                     typename std::conditional<as_is || offset_fits, U, typename next::type>::type>::type;
 
-            return result;
-        }
+        // whether the value - F is kept instead of the value
+        static const bool offset = as_is ? false : offset_fits ? true : next::offset;
+    };
 
-        friend Spill_Proof operator+ (const Spill_Proof& a, const T b) {
-            return a + Spill_Proof(b);
-        }
+    template <typename T, long long int F, long long int L, std::size_t Size>
+    struct Storage<T, F, L, Size, false> {
+        using type = T;
 
-        friend Spill_Proof operator+ (const T b, const Spill_Proof& a) {
-            return a + b;
-        }
+        static const bool offset = false;
+    };
 
-        friend Spill_Proof operator- (const Spill_Proof& a, const Spill_Proof& b) {
-            Spill_Proof result;
+    // storage of Range_Type<T, F, L>, a full T under RANGE_TYPE_COMPACT 0
+    template <typename T, long long int F, long long int L>
+    using Storage_Of = Storage<T, F, L, RANGE_TYPE_COMPACT ? 1 : sizeof(T)>;
+}
 
-            result.multiplier = a.multiplier - b.multiplier;
-            result.remainder  = a.remainder;
-            if (result.remainder.value() < b.remainder.value()) {
-                result.multiplier--;
-            }
-            result.remainder -= b.remainder;
+template <typename T, long long int F, long long int L, typename Policy = Throw_On_Violation>
+class Range_Type {
 
-            return result;
-        }
+    static_assert(std::is_integral<T>::value,
+                  "Type must be integral");
 
-        friend Spill_Proof operator- (const Spill_Proof& a, const T b) {
-            return a - Spill_Proof(b);
-        }
+    static_assert(F >= std::numeric_limits<T>::min(),
+                  "First is smaller than type minimum possible value");
 
-        friend Spill_Proof operator- (const T b, const Spill_Proof& a) {
-            return a - b;
-        }
+    static_assert(L <= std::numeric_limits<T>::max(),
+                  "Last exceeds type maximum possible value");
 
-        Spill_Proof operator+= (const Spill_Proof& a) {
-            *this = *this + a;
-            return *this;
-        }
+    static_assert(F <= L,
+                  "First is larger than last");
 
-        Spill_Proof operator+= (const T a) {
-            *this = *this + a;
-            return *this;
-        }
+public:
+    // Range_Type under Status_On_Violation, Range_Type itself otherwise
+    using result_type = typename std::conditional<Policy::reports_status,
+                                                  Range_Result<Range_Type>,
+                                                  Range_Type
+                                                 >::type;
+
+    // iteration over all of [F, L], last value included
+    // each value is in range by construction, so stepping through them is not checked
+    using iterator = Range_Iterator<T, F, L>;
+
+    static RANGE_TYPE_CONSTEXPR iterator begin () {
+        return Range_Values<T, F, L>::begin();
+    }
 
-        Spill_Proof operator-= (const Spill_Proof& a) {
-            *this = *this - a;
-            return *this;
-        }
+    static RANGE_TYPE_CONSTEXPR iterator end () {
+        return Range_Values<T, F, L>::end();
+    }
 
-        Spill_Proof operator-= (const T a) {
-            *this = *this - a;
-            return *this;
-        }
+    static RANGE_TYPE_CONSTEXPR Range_Values<T, F, L> values () {
+        return Range_Values<T, F, L>();
+    }
 
-        friend bool operator< (const Spill_Proof& a, const Spill_Proof& b) {
-            if (a.multiplier == b.multiplier) {
-                return a.remainder.value() < b.remainder.value();
-            }
-            else {
-                return a.multiplier < b.multiplier;
-            }
-        }
+    // type the value is stored in, see range_type_storage, the value is always given back as T
+    using storage_type = typename range_type_storage::Storage_Of<T, F, L>::type;
 
-        friend bool operator< (const Spill_Proof& a, const T b) {
-            return a < Spill_Proof(b);
-        }
+    // class constructors and other functions
+    RANGE_TYPE_CONSTEXPR Range_Type () : raw {to_storage(T(F))} {}
 
-        friend bool operator< (const T b, const Spill_Proof& a) {
-            return a < b;
-        }
+    // under Status_On_Violation an out of range a gives first value, use make to see the status
+    RANGE_TYPE_CONSTEXPR Range_Type (T a) : raw {to_storage(value_of(check(a, F)))} {}
 
-        friend bool operator>= (const Spill_Proof& a, const Spill_Proof& b) {
-            return !(a < b);
-        }
+    RANGE_TYPE_CONSTEXPR Range_Type (const Range_Type& a) : raw {a.raw} {};
 
-        friend bool operator>= (const Spill_Proof& a, const T b) {
-            return !(a < b);
-        }
+    static RANGE_TYPE_CONSTEXPR result_type make (T a) {
+        return check(a, F);
+    }
 
-        friend bool operator>= (const T b, const Spill_Proof& a) {
-            return !(a < b);
-        }
+    RANGE_TYPE_CONSTEXPR Range_Type operator= (const Range_Type& a) {
+        this->raw = a.raw;
+        return *this;
+    }
 
-        friend bool operator> (const Spill_Proof& a, const Spill_Proof& b) {
-            if (a.multiplier == b.multiplier) {
-                return a.remainder.value() > b.remainder.value();
-            }
-            else {
-                return a.multiplier > b.multiplier;
-            }
-        }
+    RANGE_TYPE_CONSTEXPR result_type operator= (const T& a) {
+        return assign(check(a, value()));
+    }
 
-        friend bool operator<= (const Spill_Proof& a, const Spill_Proof& b) {
-            return !(a > b);
-        }
+    RANGE_TYPE_CONSTEXPR operator T () const {
+        return value();
+    }
 
-        friend bool operator== (const Spill_Proof& a, const Spill_Proof& b) {
-            if (a.multiplier == b.multiplier) {
-                return a.remainder.value() == b.remainder.value();
-            }
-            else {
-                return false;
-            }
-        }
+    template<typename ANY_T>
+    operator ANY_T () const = delete;
 
-    private:
-        T multiplier;
-        Mod_Type<T, T_max> remainder;
-    };
+    RANGE_TYPE_CONSTEXPR T value () const {
+        return from_storage(this->raw);
+    }
+
+    RANGE_TYPE_CONSTEXPR T first () const {
+        return this->lower_limit;
+    }
+
+    RANGE_TYPE_CONSTEXPR T last () const {
+        return this->upper_limit;
+    }
+
+    RANGE_TYPE_CONSTEXPR T size () const {
+        return this->upper_limit - this->lower_limit + 1;
+    }
+
+    friend std::ostream& operator<< (std::ostream& out, const Range_Type& a) {
+        out << +a.value();
+        return out;
+    }
+
+    RANGE_TYPE_CONSTEXPR Range_Type operator+ () const {
+        return *this;
+    }
+
+    RANGE_TYPE_CONSTEXPR result_type operator- () const {
+        return check(-value(), value());
+    }
 
+    friend RANGE_TYPE_CONSTEXPR result_type operator+ (const Range_Type& a, const Range_Type& b) {
+        return val_add(a.value(), b.value(), a.value());
+    }
+
+    friend RANGE_TYPE_CONSTEXPR result_type operator+ (const Range_Type& a, const T& b) {
+        return val_add(a.value(), b,         a.value());
+    }
+
+    friend RANGE_TYPE_CONSTEXPR result_type operator+ (const T& b, const Range_Type& a) {
+        return val_add(b,         a.value(), a.value());
+    }
+
+    friend RANGE_TYPE_CONSTEXPR result_type operator- (const Range_Type& a, const Range_Type& b) {
+        return val_sub(a.value(), b.value(), a.value());
+    }
+
+    friend RANGE_TYPE_CONSTEXPR result_type operator- (const Range_Type& a, const T& b) {
+        return val_sub(a.value(), b,         a.value());
+    }
+
+    friend RANGE_TYPE_CONSTEXPR result_type operator- (const T& b, const Range_Type& a) {
+        return val_sub(b,         a.value(), a.value());
+    }
+
+    friend RANGE_TYPE_CONSTEXPR result_type operator* (const Range_Type& a, const Range_Type& b) {
+        return val_mul(a.value(), b.value(), a.value());
+    }
+
+    friend RANGE_TYPE_CONSTEXPR result_type operator* (const Range_Type& a, const T& b) {
+        return val_mul(a.value(), b,         a.value());
+    }
+
+    friend RANGE_TYPE_CONSTEXPR result_type operator* (const T& b, const Range_Type& a) {
+        return val_mul(b,         a.value(), a.value());
+    }
+
+    RANGE_TYPE_CONSTEXPR result_type operator++ () {
+        return (*this) += 1;
+    }
+
+    RANGE_TYPE_CONSTEXPR result_type operator++ (int) {
+        T ret = value();
+        return with_value(ret, (*this) += 1);
+    }
+
+    RANGE_TYPE_CONSTEXPR result_type operator-- () {
+        return (*this) -= 1;
+    }
+
+    RANGE_TYPE_CONSTEXPR result_type operator-- (int) {
+        T ret = value();
+        return with_value(ret, (*this) -= 1);
+    }
+
+    RANGE_TYPE_CONSTEXPR result_type operator+= (const Range_Type& a) {
+        return assign(val_add(value(), a.value(), value()));
+    }
+
+    RANGE_TYPE_CONSTEXPR result_type operator+= (const T& a) {
+        return assign(val_add(value(), a, value()));
+    }
+
+    RANGE_TYPE_CONSTEXPR result_type operator-= (const Range_Type& a) {
+        return assign(val_sub(value(), a.value(), value()));
+    }
+
+    RANGE_TYPE_CONSTEXPR result_type operator-= (const T& a) {
+        return assign(val_sub(value(), a, value()));
+    }
+
+    RANGE_TYPE_CONSTEXPR result_type operator*= (const Range_Type& a) {
+        return assign(val_mul(value(), a.value(), value()));
+    }
+
+    RANGE_TYPE_CONSTEXPR result_type operator*= (const T& a) {
+        return assign(val_mul(value(), a, value()));
+    }
+
+    friend RANGE_TYPE_CONSTEXPR bool operator== (const Range_Type& a, const Range_Type& b) {
+        return a.raw == b.raw;
+    }
+
+    friend RANGE_TYPE_CONSTEXPR bool operator!= (const Range_Type& a, const Range_Type& b) {
+        return a.raw != b.raw;
+    }
+
+private:
     static const T lower_limit = F;
     static const T upper_limit = L;
-    T val;
+    storage_type raw;
+
+    struct unchecked_tag {};
+
+    RANGE_TYPE_CONSTEXPR Range_Type (T a, unchecked_tag) : raw {to_storage(a)} {}
+
+    // types holding values already known to be in [F, L]
+    template <typename, long long int, long long int, typename> friend class Range_Vector;
+    template <typename, long long int, long long int, typename> friend class Range_Interval;
+    template <typename, long long int, long long int, typename> friend class Atomic_Range_Type;
+    template <typename, long long int, long long int, typename> friend class Packed_Range_Array;
+
+    using reports_status = std::integral_constant<bool, Policy::reports_status>;
 
-    static T low_limit () {
-        return F;
+    // result of an operation that stayed in range
+    static RANGE_TYPE_CONSTEXPR result_type success (T r) {
+        return success(r, reports_status());
     }
 
-    static T up_limit () {
-        return L;
+    static RANGE_TYPE_CONSTEXPR Range_Type success (T r, std::false_type) {
+        return Range_Type(r, unchecked_tag());
     }
 
-    static T val_check (const T val) {
-        std::ostringstream error_message;
+    static RANGE_TYPE_CONSTEXPR Range_Result<Range_Type> success (T r, std::true_type) {
+        return Range_Result<Range_Type>(Range_Type(r, unchecked_tag()), Range_Status::ok);
+    }
 
-        if (val < F) {
-            error_message << "Range : [ " << +low_limit() << ", " << +up_limit() << " ]    ";
-            error_message << "Goal : "    << +val           << std::endl;
-            error_message << "Value is lower than smallest possible value";
-            throw RangeTypeException(error_message.str());
-        }
+    // result of a failing a op b, handed over to Policy
+    // keep is the value left in place when Policy reports status
+    static RANGE_TYPE_CONSTEXPR result_type violation (Range_Status status, char op, T a, T b, T keep) {
+        CHECK_STATS_ADD(stats_site(), status == Range_Status::underflow ? Check_Event::underflow : Check_Event::overflow);
+        return violation(status, op, a, b, keep, reports_status());
+    }
 
-        if (val > L) {
-            error_message << "Range : [ " << +low_limit() << ", " << +up_limit() << " ]    ";
-            error_message << "Goal : "    << +val           << std::endl;
-            error_message << "Value is greater than largest possible value";
-            throw RangeTypeException(error_message.str());
+    static RANGE_TYPE_CONSTEXPR Range_Type violation (Range_Status status, char op, T a, T b, T, std::false_type) {
+#if CHECK_STATS
+        if (check_stats::counting()) {
+            return Range_Type(timed_on_violation(status, op, a, b), unchecked_tag());
         }
+#endif
+        return Range_Type(Policy::template on_violation<T, F, L>(status, op, a, b), unchecked_tag());
+    }
 
-        return val;
+    static RANGE_TYPE_CONSTEXPR Range_Result<Range_Type> violation (Range_Status status, char, T, T, T keep, std::true_type) {
+        return Range_Result<Range_Type>(Range_Type(keep, unchecked_tag()), status);
     }
 
-    // all arithmetic functions do not check b for range
+#if CHECK_STATS || RANGE_PROFILE
+    static std::string site_name () {
+        return check_stats::site_name("Range_Type", check_stats::type_name<T>(), F, L, range_type_stats::policy_name<Policy>());
+    }
+#endif
 
-    T val_add (T a, T b) const {
-        std::ostringstream error_message;
+#if RANGE_PROFILE
+    static std::size_t profile_site () {
+        static const std::size_t site = range_profile::register_site(site_name());
+        return site;
+    }
+#endif
 
-        val_check(a);
+#if CHECK_STATS
+    static std::size_t stats_site () {
+        static const std::size_t site = check_stats::register_site(site_name());
+        return site;
+    }
 
-        Spill_Proof up_space_left_a  = Spill_Proof(upper_limit) - Spill_Proof(a);
-        Spill_Proof low_space_left_a = Spill_Proof(a)           - Spill_Proof(lower_limit);
+    // time spent in Policy, up to its return or throw
+    static T timed_on_violation (Range_Status status, char op, T a, T b) {
+        check_stats::Slow_Path_Timer timer(stats_site());
+        return Policy::template on_violation<T, F, L>(status, op, a, b);
+    }
+#endif
 
-        if (b >= 0) {   // normal addition
-            if (up_space_left_a < b) {
-                error_message << "Range : [ " << +low_limit() << ", " << +up_limit() << " ]    ";
-                error_message << "Operation : " << +a << " + " << +b << std::endl;
-                error_message << "Addition causes overflow";
-                throw RangeTypeException(error_message.str());
-            }
+    static RANGE_TYPE_CONSTEXPR storage_type to_storage (T a) {
+        using storage = range_type_storage::Storage_Of<T, F, L>;
 
-            a += b;
-        }
-        else {  // subtraction
-            T t_val = 0;
-
-            if (b == std::numeric_limits<T>::min()) {
-                // prevent negating from wrapping back to same value
-                // this is to deal with case where number of negative values is one greater than number of non-negative values
-                // aka two's complement
-                t_val = 1;      // put 1 aside to avoid overflow in negation
-                b += t_val;
-
-                b = -b;
-                if (low_space_left_a == 0) {
-                    error_message << "Range : [ " << +low_limit() << ", " << +up_limit() << " ]    ";
-                    error_message << "Operation : " << +a << " + (" << +std::numeric_limits<T>::min() << ")" << std::endl;
-                    error_message << "Addition causes underflow";
-                    throw RangeTypeException(error_message.str());
-                }
-                else if (low_space_left_a > 0) {
-                    if (low_space_left_a - t_val < b) {
-                        error_message << "Range : [ " << +low_limit() << ", " << +up_limit() << " ]    ";
-                        error_message << "Operation : " << +a << " + (" << +std::numeric_limits<T>::min() << ")" << std::endl;
-                        error_message << "Addition causes underflow";
-                        throw RangeTypeException(error_message.str());
-                    }
-                }
-                /* low_space_left_a < 0 will not hold due to val_check at front */
-            }
-            else {
-                b = -b;
-                if (low_space_left_a < b) {
-                    error_message << "Range : [ " << +low_limit() << ", " << +up_limit() << " ]    ";
-                    error_message << "Operation : " << +a << " + (-" << +b << ")" << std::endl;
-                    error_message << "Addition causes underflow";
-                    throw RangeTypeException(error_message.str());
-                }
-            }
+        return storage::offset ? storage_type((unsigned long long) a - (unsigned long long) F) : storage_type(a);
+    }
 
-            a -= b;
-            a -= t_val;
-        }
+    static RANGE_TYPE_CONSTEXPR T from_storage (storage_type a) {
+        using storage = range_type_storage::Storage_Of<T, F, L>;
 
-        return a;
+        return storage::offset ? T((unsigned long long) F + (unsigned long long) a) : T(a);
     }
 
-    T val_sub (T a, T b) const {
-        std::ostringstream error_message;
+    static RANGE_TYPE_CONSTEXPR T value_of (const Range_Type& r) {
+        return r.value();
+    }
 
-        val_check(a);
+    static RANGE_TYPE_CONSTEXPR T value_of (const Range_Result<Range_Type>& r) {
+        return r.value().value();
+    }
 
-        Spill_Proof up_space_left_a  =  Spill_Proof (upper_limit) - Spill_Proof(a);
-        Spill_Proof low_space_left_a =  Spill_Proof(a)            - Spill_Proof(lower_limit);
+    static RANGE_TYPE_CONSTEXPR Range_Type with_value (T a, const Range_Type&) {
+        return Range_Type(a, unchecked_tag());
+    }
 
-        if (b >= 0) {   // normal subtraction
-            if (low_space_left_a < b) {
-                error_message << "Range : [ " << +low_limit() << ", " << +up_limit() << " ]    ";
-                error_message << "Operation : " << +a << " - " << +b << std::endl;
-                error_message << "Subtraction causes underflow";
-                throw RangeTypeException(error_message.str());
-            }
+    static RANGE_TYPE_CONSTEXPR Range_Result<Range_Type> with_value (T a, const Range_Result<Range_Type>& r) {
+        return Range_Result<Range_Type>(Range_Type(a, unchecked_tag()), r.status());
+    }
 
-            a -= b;
+    RANGE_TYPE_CONSTEXPR result_type assign (const result_type& r) {
+        this->raw = to_storage(value_of(r));
+        return r;
+    }
+
+    using unsigned_T = typename std::make_unsigned<T>::type;
+
+    // whether a is in [F, L], with a single unsigned comparison
+    static RANGE_TYPE_CONSTEXPR bool in_range (const T a) {
+        return unsigned_T(unsigned_T(a) - unsigned_T(F)) <= unsigned_T(unsigned_T(L) - unsigned_T(F));
+    }
+
+    static RANGE_TYPE_CONSTEXPR result_type check (const T val, const T keep) {
+        CHECK_STATS_ADD(stats_site(), Check_Event::check);
+        RANGE_PROFILE_RECORD(profile_site(), val);
+
+        if (RANGE_TYPE_UNLIKELY(!in_range(val))) {
+            return violation(val < F ? Range_Status::underflow : Range_Status::overflow, 0, val, 0, keep);
         }
-        else {  // addition
-            T t_val = 0;
-
-            if (b == std::numeric_limits<T>::min()) {
-                // prevent negating from wrapping back to same value
-                // this is to deal with case where number of negative values is one greater than number of non-negative values
-                // aka two's complement
-                t_val = 1;      // put 1 aside to avoid overflow in negation
-                b += t_val;
-
-                b = -b;
-                if (up_space_left_a == 0) {
-                    error_message << "Range : [ " << +low_limit() << ", " << +up_limit() << " ]    ";
-                    error_message << "Operation : " << +a << " - (" << +std::numeric_limits<T>::min() << ")" << std::endl;
-                    error_message << "Subtraction causes overflow";
-                    throw RangeTypeException(error_message.str());
-                }
-                else if (up_space_left_a > 0) {
-                    if (up_space_left_a - t_val < b) {
-                        error_message << "Range : [ " << +low_limit() << ", " << +up_limit() << " ]    ";
-                        error_message << "Operation : " << +a << " - (" << +std::numeric_limits<T>::min() << ")" << std::endl;
-                        error_message << "Subtraction causes overflow";
-                        throw RangeTypeException(error_message.str());
-                    }
-                }
-                /* up_space_left_a < 0 will not hold due to val_check at front */
-            }
-            else {
-                b = -b;
-                if (up_space_left_a < b) {
-                    error_message << "Range : [ " << +low_limit() << ", " << +up_limit() << " ]    ";
-                    error_message << "Operation : " << +a << " - (-" << +b << ")" << std::endl;
-                    error_message << "Subtraction causes overflow";
-                    throw RangeTypeException(error_message.str());
-                }
-            }
 
-            a += b;
-            a += t_val;
+        return success(val);
+    }
+
+    // r is the result of a op b, known to fit in T
+    static RANGE_TYPE_CONSTEXPR result_type result_check (const T r, char op, T a, T b, T keep) {
+        CHECK_STATS_ADD(stats_site(), Check_Event::check);
+        RANGE_PROFILE_RECORD(profile_site(), r);
+
+        if (RANGE_TYPE_UNLIKELY(!in_range(r))) {
+            return violation(r < F ? Range_Status::underflow : Range_Status::overflow, op, a, b, keep);
         }
 
-        return a;
+        return success(r);
     }
 
-    T val_mul (T a, T b) const {
-        std::ostringstream error_message;
+    // all arithmetic functions do not check b for range
 
-        val_check(a);
+    static RANGE_TYPE_CONSTEXPR result_type val_add (T a, T b, T keep) {
+        if (RANGE_TYPE_UNLIKELY(!in_range(a))) {
+            return check(a, keep);
+        }
 
-        T max_multiplier_a_pos;
-        T max_multiplier_a_neg;
+        T r = 0;
 
-        if (a >= 0) {
-            if (upper_limit >= 0) {
-                max_multiplier_a_pos = upper_limit / a;
-            }
-            else {
-                max_multiplier_a_pos = 0;
-            }
+        if (RANGE_TYPE_UNLIKELY(!range_type_arith::add(a, b, r))) {
+            // exact result is beyond T, so also beyond [F, L] on the side b points to
+            CHECK_STATS_ADD(stats_site(), Check_Event::check);
+            return violation(b < 0 ? Range_Status::underflow : Range_Status::overflow, '+', a, b, keep);
+        }
 
-            if (lower_limit >= 0) {
-                max_multiplier_a_neg = 0;
-            }
-            else {
-                max_multiplier_a_neg = lower_limit / a;
-            }
+        return result_check(r, '+', a, b, keep);
+    }
+
+    static RANGE_TYPE_CONSTEXPR result_type val_sub (T a, T b, T keep) {
+        if (RANGE_TYPE_UNLIKELY(!in_range(a))) {
+            return check(a, keep);
         }
-        else {
-            if (upper_limit >= 0) {
-                max_multiplier_a_neg = upper_limit / a;
-            }
-            else {
-                max_multiplier_a_neg = 0;
-            }
 
-            if (lower_limit >= 0) {
-                max_multiplier_a_pos = 0;
-            }
-            else {
-                max_multiplier_a_pos = lower_limit / a;
-            }
+        T r = 0;
+
+        if (RANGE_TYPE_UNLIKELY(!range_type_arith::sub(a, b, r))) {
+            CHECK_STATS_ADD(stats_site(), Check_Event::check);
+            return violation(b < 0 ? Range_Status::overflow : Range_Status::underflow, '-', a, b, keep);
         }
 
-        if (b >= 0) {
-            if (max_multiplier_a_pos < b) {
-                error_message << "Range : [ " << +low_limit() << ", " << +up_limit() << " ]    ";
-                error_message << "Operation : " << +a << " * " << +b << std::endl;
-                if (a >= 0) {
-                    error_message << "Multiplication causes overflow";
-                }
-                else {
-                    error_message << "Multiplication causes underflow";
-                }
-                throw RangeTypeException(error_message.str());
-            }
+        return result_check(r, '-', a, b, keep);
+    }
 
-            a *= b;
+    static RANGE_TYPE_CONSTEXPR result_type val_mul (T a, T b, T keep) {
+        if (RANGE_TYPE_UNLIKELY(!in_range(a))) {
+            return check(a, keep);
         }
-        else {
-            if (max_multiplier_a_neg > b) {
-                error_message << "Range : [ " << +low_limit() << ", " << +up_limit() << " ]    ";
-                error_message << "Operation : " << +a << " * " << +b << std::endl;
-                if (a >= 0) {
-                    error_message << "Multiplication causes underflow";
-                }
-                else {
-                    error_message << "Multiplication causes overflow";
-                }
-                throw RangeTypeException(error_message.str());
-            }
 
-            a *= b;
+        T r = 0;
+
+        if (RANGE_TYPE_UNLIKELY(!range_type_arith::mul(a, b, r))) {
+            // product is negative exactly when the signs differ
+            CHECK_STATS_ADD(stats_site(), Check_Event::check);
+            return violation((a < 0) != (b < 0) ? Range_Status::underflow : Range_Status::overflow, '*', a, b, keep);
         }
 
-        return a;
+        return result_check(r, '*', a, b, keep);
     }
 };
 
-template<typename T>
-using No_Wrap = Range_Type<T, std::numeric_limits<T>::min(), std::numeric_limits<T>::max()>;
-
-#endif // RANGE_TYPE_H_INCLUDED
+template<typename T, typename Policy = Throw_On_Violation>
+using No_Wrap = Range_Type<T, std::numeric_limits<T>::min(), std::numeric_limits<T>::max(), Policy>;
+
+#if __cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)
+#include <ranges>
+
+#if defined(__cpp_lib_ranges)
+// iterators do not refer back to the range they came from
+template <typename T, long long int F, long long int L>
+inline constexpr bool std::ranges::enable_borrowed_range<Range_Values<T, F, L>> = true;
+
+template <typename T, long long int F, long long int L>
+inline constexpr bool std::ranges::enable_view<Range_Values<T, F, L>> = true;
+
+template <typename T, long long int F, long long int L, typename Policy>
+inline constexpr bool std::ranges::enable_borrowed_range<Range_Type<T, F, L, Policy>> = true;
+#endif
+#endif
+
+#endif // RANGE_TYPE_H_INCLUDED
@@ -0,0 +1,307 @@
+/* Contiguous container of Range_Type values, stored as plain T
+ * Values are validated a block at a time when they enter the container, reads are not checked again
+ * Exception RangeVectorException is thrown when a value is out of range under Throw_On_Violation
+ * RangeVectorException.index() gives the position of the first offending value
+ *
+ * License:
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <sstream>
+#include <type_traits>
+#include <vector>
+#include "range_type.h"
+
+#ifndef RANGE_VECTOR_H_INCLUDED
+#define RANGE_VECTOR_H_INCLUDED
+
+class RangeVectorException : public RangeTypeException {
+public:
+    RangeVectorException (std::string errMsg, std::size_t index) : RangeTypeException(errMsg), err_index {index} {}
+
+    std::size_t index () const {
+        return this->err_index;
+    }
+private:
+    std::size_t err_index;
+};
+
+namespace range_vector_error {
+    // Index : i    Range : [ first, last ]    Goal : a
+    template <typename W>
+    [[noreturn]] RANGE_TYPE_COLD
+    void raise (std::size_t index, W first, W last, Range_Status status, W a) {
+        std::ostringstream error_message;
+
+        error_message << "Index : " << index << "    " << range_type_error::format<W>(first, last, status, 0, a, 0);
+
+#if RANGE_TYPE_EXCEPTIONS
+        throw RangeVectorException(error_message.str(), index);
+#else
+        std::fputs(error_message.str().c_str(), stderr);
+        std::fputc('\n', stderr);
+        std::abort();
+#endif
+    }
+}
+
+// Bulk operations return the index of the first value found outside [F, L], or npos if there is none
+// What happens to that value depends on Policy
+//     Throw_On_Violation   : throws RangeVectorException, the container is left as it was before the call
+//     Status_On_Violation  : nothing is stored, the container is left as it was before the call
+//     other policies       : each offending value is replaced as the policy does for Range_Type
+// except that assign leaves the container empty where it would be left as it was
+template <typename T, long long int F, long long int L, typename Policy = Throw_On_Violation>
+class Range_Vector {
+public:
+    using value_type = Range_Type<T, F, L, Policy>;
+
+    static const std::size_t npos = std::size_t(-1);
+
+    Range_Vector () {}
+
+    // n copies of F
+    explicit Range_Vector (std::size_t n) : vals(n, T(F)) {}
+
+    // unchecked, the value is already in range
+    value_type operator[] (std::size_t i) const {
+        return value_type(vals[i], typename value_type::unchecked_tag());
+    }
+
+    void set (std::size_t i, const value_type& a) {
+        vals[i] = a.value();
+    }
+
+    // underlying values, each in [F, L]
+    const T* data () const {
+        return vals.data();
+    }
+
+    const T* begin () const {
+        return vals.data();
+    }
+
+    const T* end () const {
+        return vals.data() + vals.size();
+    }
+
+    std::size_t size () const {
+        return vals.size();
+    }
+
+    bool empty () const {
+        return vals.empty();
+    }
+
+    void reserve (std::size_t n) {
+        vals.reserve(n);
+    }
+
+    void clear () {
+        vals.clear();
+    }
+
+    void push_back (const value_type& a) {
+        vals.push_back(a.value());
+    }
+
+    std::size_t push_back (T a) {
+        return append(&a, 1);
+    }
+
+    std::size_t append (const T* a, std::size_t n) {
+        if (RANGE_TYPE_UNLIKELY(aliases(a))) {
+            std::vector<T> copy(a, a + n);
+            return store(copy.data(), n);
+        }
+
+        return store(a, n);
+    }
+
+    std::size_t append (const std::vector<T>& a) {
+        return append(a.data(), a.size());
+    }
+
+    std::size_t assign (const T* a, std::size_t n) {
+        if (RANGE_TYPE_UNLIKELY(aliases(a))) {
+            std::vector<T> copy(a, a + n);
+            vals.clear();
+            return store(copy.data(), n);
+        }
+
+        vals.clear();
+
+        return store(a, n);
+    }
+
+    std::size_t assign (const std::vector<T>& a) {
+        return assign(a.data(), a.size());
+    }
+
+    // index of the first value in a[0 .. n) outside [F, L], or npos
+    static std::size_t find_invalid (const T* a, std::size_t n) {
+        for (std::size_t i = 0; i < n; i += block) {
+            std::size_t len = n - i < block ? n - i : block;
+
+            if (RANGE_TYPE_UNLIKELY(!block_in_range(a + i, len))) {
+                return i + first_invalid(a + i, len);
+            }
+        }
+
+        return npos;
+    }
+
+    friend bool operator== (const Range_Vector& a, const Range_Vector& b) {
+        return a.vals == b.vals;
+    }
+
+    friend bool operator!= (const Range_Vector& a, const Range_Vector& b) {
+        return a.vals != b.vals;
+    }
+
+private:
+    // values are validated a block at a time and copied while the block is still in cache
+    static const std::size_t block = 4096;
+
+    std::vector<T> vals;
+
+    // a - F wraps around past L - F when a is below F, so one unsigned compare covers both ends,
+    // or'ed together branch free so it vectorises, and cheaper than a min/max pass, which x86-64 before SSE4.1 lacks
+    // the inner loop has a fixed trip count, so this holds even under the cheap cost model of -O2
+    static bool block_in_range (const T* a, std::size_t n) {
+        using unsigned_T = typename std::make_unsigned<T>::type;
+
+        const std::size_t chunk = 64;
+        const unsigned_T range  = unsigned_T(unsigned_T(L) - unsigned_T(F));
+
+        unsigned_T outside = 0;
+        std::size_t i = 0;
+
+        for (; i + chunk <= n; i += chunk) {
+            for (std::size_t j = 0; j < chunk; j++) {
+                outside |= unsigned_T(unsigned_T(unsigned_T(a[i + j]) - unsigned_T(F)) > range);
+            }
+        }
+
+        for (; i < n; i++) {
+            outside |= unsigned_T(unsigned_T(unsigned_T(a[i]) - unsigned_T(F)) > range);
+        }
+
+        return outside == 0;
+    }
+
+    RANGE_TYPE_COLD
+    static std::size_t first_invalid (const T* a, std::size_t n) {
+        std::size_t i = 0;
+
+        while (i < n && a[i] >= F && a[i] <= L) {
+            i++;
+        }
+
+        return i;
+    }
+
+    // whether a points into vals, which store may reallocate or overwrite before a is read
+    bool aliases (const T* a) const {
+        return !std::less<const T*>()(a, vals.data()) && std::less<const T*>()(a, vals.data() + vals.capacity());
+    }
+
+    static Range_Status status_of (T a) {
+        return a < F ? Range_Status::underflow : Range_Status::overflow;
+    }
+
+    // appends a[0 .. n), growing vals without zero filling it first
+    std::size_t store (const T* a, std::size_t n) {
+        std::size_t old_size = vals.size();
+        std::size_t result   = npos;
+
+        vals.reserve(old_size + n);
+
+        for (std::size_t i = 0; i < n; i += block) {
+            std::size_t len = n - i < block ? n - i : block;
+            bool valid = block_in_range(a + i, len);
+
+            if (RANGE_TYPE_UNLIKELY(!valid)) {
+                std::size_t bad = i + first_invalid(a + i, len);
+
+                if (result == npos) {
+                    result = bad;
+                }
+
+                if (!on_invalid(a, bad, old_size, Policy())) {
+                    return result;
+                }
+            }
+
+            vals.insert(vals.end(), a + i, a + i + len);
+
+            if (RANGE_TYPE_UNLIKELY(!valid)) {
+                fix(vals.data() + vals.size() - len, len);
+            }
+        }
+
+        return result;
+    }
+
+    // true if the policy replaces offending values and storing carries on
+    bool on_invalid (const T* a, std::size_t bad, std::size_t offset, Throw_On_Violation) {
+        vals.resize(offset);
+        range_vector_error::raise<range_type_error::wide<T>>(bad, F, L, status_of(a[bad]), a[bad]);
+    }
+
+    template <typename P>
+    bool on_invalid (const T*, std::size_t, std::size_t offset, P) {
+        if (P::reports_status) {
+            vals.resize(offset);
+            return false;
+        }
+
+        return true;
+    }
+
+    void fix (T* a, std::size_t n) {
+        for (std::size_t i = 0; i < n; i++) {
+            a[i] = value_of(a[i], std::integral_constant<bool, Policy::reports_status>());
+        }
+    }
+
+    static T value_of (T a, std::false_type) {
+        if (a >= F && a <= L) {
+            return a;
+        }
+
+        return Policy::template on_violation<T, F, L>(status_of(a), 0, a, 0);
+    }
+
+    static T value_of (T a, std::true_type) {
+        return a;
+    }
+};
+
+#endif // RANGE_VECTOR_H_INCLUDED
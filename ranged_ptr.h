@@ -1,3 +1,7 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <ostream>
 #include <string>
@@ -14,11 +18,156 @@ public:
 private:
 };
 
-template <typename T>
+// Error message formatting for Ranged_Ptr, kept out of line in the same way as range_type_error
+namespace ranged_ptr_error {
+    [[noreturn]] RANGE_TYPE_COLD
+    inline void raise (const std::string& message) {
+#if RANGE_TYPE_EXCEPTIONS
+        throw RangedPtrException(message);
+#else
+        std::fputs(message.c_str(), stderr);
+        std::fputc('\n', stderr);
+        std::abort();
+#endif
+    }
+
+    [[noreturn]] RANGE_TYPE_COLD
+    inline void raise_different_base (const char* reason,
+                                      const char* left_name,  const void* left,
+                                      const char* right_name, const void* right) {
+        std::ostringstream error_message;
+
+        error_message << reason << "    ";
+        error_message << left_name << " : " << left << " " << right_name << " : " << right;
+        raise(error_message.str());
+    }
+
+    // op is '+', '-', or 0 for a plain check of a pointer value
+    // width is the number of bytes accessed from the resulting pointer
+    inline const char* reason (char op, std::size_t width) {
+        if (width > 1) {
+            return "Load/store through pointer reaches out of bound";
+        }
+
+        switch (op) {
+            case '+' : return "Pointer addition results in out of bound pointer value";
+            case '-' : return "Pointer subtraction results in out of bound pointer value";
+            default  : return "Goal pointer value out of bound";
+        }
+    }
+
+    [[noreturn]] RANGE_TYPE_COLD
+    inline void raise_out_of_bound (const char* reason,
+                                    const void* first, const void* last, const void* goal,
+                                    const std::string& index_message) {
+        std::ostringstream error_message;
+
+        error_message << reason << std::endl;
+        error_message << "Expressed in pointers:" << std::endl;
+        error_message << "Range : [ " << first << ", " << last << " ]    ";
+        error_message << "Goal : " << goal << std::endl;
+        error_message << "Expressed in indices:" << std::endl;
+        error_message << index_message;
+        raise(error_message.str());
+    }
+}
+
+// Byte order of a value loaded or stored through Ranged_Ptr
+enum class Byte_Order {
+    native,
+    little,
+    big
+};
+
+namespace ranged_ptr_arith {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    const Byte_Order native_order = Byte_Order::big;
+#else
+    const Byte_Order native_order = Byte_Order::little;
+#endif
+
+    template <std::size_t N> struct uint_of_size;
+    template <> struct uint_of_size<1> { using type = uint8_t;  };
+    template <> struct uint_of_size<2> { using type = uint16_t; };
+    template <> struct uint_of_size<4> { using type = uint32_t; };
+    template <> struct uint_of_size<8> { using type = uint64_t; };
+
+    inline uint8_t byte_swap (uint8_t a) {
+        return a;
+    }
+
+    inline uint16_t byte_swap (uint16_t a) {
+#if defined(__GNUC__)
+        return __builtin_bswap16(a);
+#elif defined(_MSC_VER)
+        return _byteswap_ushort(a);
+#else
+        return uint16_t((a << 8) | (a >> 8));
+#endif
+    }
+
+    inline uint32_t byte_swap (uint32_t a) {
+#if defined(__GNUC__)
+        return __builtin_bswap32(a);
+#elif defined(_MSC_VER)
+        return _byteswap_ulong(a);
+#else
+        return (uint32_t(byte_swap(uint16_t(a))) << 16) | byte_swap(uint16_t(a >> 16));
+#endif
+    }
+
+    inline uint64_t byte_swap (uint64_t a) {
+#if defined(__GNUC__)
+        return __builtin_bswap64(a);
+#elif defined(_MSC_VER)
+        return _byteswap_uint64(a);
+#else
+        return (uint64_t(byte_swap(uint32_t(a))) << 32) | byte_swap(uint32_t(a >> 32));
+#endif
+    }
+
+    // a with its bytes reversed if order is not the native byte order
+    template <typename U>
+    U to_order (U a, Byte_Order order) {
+        static_assert(sizeof(U) == 1 || sizeof(U) == 2 || sizeof(U) == 4 || sizeof(U) == 8,
+                      "Byte order conversion needs a type of 1, 2, 4 or 8 bytes");
+
+        using bits = typename uint_of_size<sizeof(U)>::type;
+
+        if (order == Byte_Order::native || order == native_order) {
+            return a;
+        }
+
+        bits raw;
+        std::memcpy(&raw, &a, sizeof(U));
+        raw = byte_swap(raw);
+        std::memcpy(&a, &raw, sizeof(U));
+
+        return a;
+    }
+}
+
+// Policy is applied to the byte index within the object, see Range_Type
+// Throw_On_Violation throws RangedPtrException, which gives both the pointer and the index view of the failure
+// Ranged_Ptr<const T> only reads, bytes are given as const unsigned char and store does not compile
+template <typename T, typename Policy = Throw_On_Violation>
 class Ranged_Ptr {
+
+    static_assert(!Policy::reports_status,
+                  "Ranged_Ptr can not report status, policy must throw, saturate, wrap or trap");
+
 private:
     using ptr_int = int32_t;
-    using T_index = Range_Type<ptr_int, 0, sizeof(T) - 1>;
+
+    // bytes are read only through a Ranged_Ptr<const T>
+    using byte = typename std::conditional<std::is_const<T>::value, const unsigned char, unsigned char>::type;
+
+    using T_index = Range_Type<ptr_int, 0, sizeof(T) - 1, Policy>;
+
+    // index of the first byte of a Width byte access
+    // current index + offset is formed in long long, so it is checked as a plain value
+    template <std::size_t Width>
+    using T_access = Range_Type<long long int, 0, sizeof(T) - Width, Policy>;
 
 public:
     Ranged_Ptr() = delete;
@@ -30,12 +179,9 @@ public:
     Ranged_Ptr(const Ranged_Ptr& r_ptr) : obj_ref {r_ptr.obj_ref}, base {r_ptr.base}, cur {ptr_check(*this, r_ptr.cur)} {}
 
     Ranged_Ptr operator= (const Ranged_Ptr& r_ptr) {
-        std::ostringstream error_message;
-
-        if (r_ptr.base != this->base) {
-            error_message << "Goal pointer has different base    ";
-            error_message << "this->base : " << (void*) this->base << " goal base : " << (void*) r_ptr.base;
-            throw RangedPtrException(error_message.str());
+        if (RANGE_TYPE_UNLIKELY(r_ptr.base != this->base)) {
+            ranged_ptr_error::raise_different_base("Goal pointer has different base",
+                                                   "this->base", this->base, "goal base", r_ptr.base);
         }
 
         this->cur = ptr_check(*this, r_ptr.cur);
@@ -53,23 +199,64 @@ public:
         return (T*) &obj_ref;
     }
 
-    unsigned char& operator* () const {
-        return *((unsigned char*) cur);
+    byte& operator* () const {
+        return *((byte*) cur);
     }
 
-    unsigned char& operator[] (ptr_int index) const {
+    byte& operator[] (ptr_int index) const {
 
-        return *((unsigned char*) ptr_add(*this, index));
+        return *((byte*) ptr_add(*this, index));
     }
 
-    operator unsigned char* () const {
+    // U read from offset bytes past the current position
+    // a single bound check covers all of [offset, offset + sizeof(U))
+    template <typename U>
+    U load (ptr_int offset) const {
+        static_assert(std::is_trivially_copyable<U>::value,
+                      "Type must be trivially copyable");
+
+        static_assert(sizeof(U) <= sizeof(T),
+                      "Type is larger than the object");
+
+        U result;
+        std::memcpy(&result, ptr_access<sizeof(U)>(*this, offset), sizeof(U));
+        return result;
+    }
+
+    // as above, converting from order to the native byte order
+    template <typename U>
+    U load (ptr_int offset, Byte_Order order) const {
+        return ranged_ptr_arith::to_order(load<U>(offset), order);
+    }
+
+    template <typename U>
+    void store (ptr_int offset, const U& value) const {
+        static_assert(!std::is_const<T>::value,
+                      "Can not store through a pointer to a const object");
+
+        static_assert(std::is_trivially_copyable<U>::value,
+                      "Type must be trivially copyable");
+
+        static_assert(sizeof(U) <= sizeof(T),
+                      "Type is larger than the object");
+
+        std::memcpy(ptr_access<sizeof(U)>(*this, offset), &value, sizeof(U));
+    }
+
+    // as above, converting from the native byte order to order
+    template <typename U>
+    void store (ptr_int offset, const U& value, Byte_Order order) const {
+        store<U>(offset, ranged_ptr_arith::to_order(value, order));
+    }
+
+    operator byte* () const {
         return cur;
     }
 
     template <typename ANY_T>
     operator ANY_T () const = delete;
 
-    unsigned char* ptr () const {
+    byte* ptr () const {
         return this->cur;
     }
 
@@ -77,12 +264,12 @@ public:
         return (T&) this->obj_ref;
     }
 
-    unsigned char* first () const {
-        return this->base;
+    byte* first () const {
+        return (byte*) this->base;
     }
 
-    unsigned char* last () const {
-        return this->base + sizeof(T) - 1;
+    byte* last () const {
+        return (byte*) this->base + sizeof(T) - 1;
     }
 
     size_t size () const {
@@ -196,12 +383,9 @@ public:
     friend bool operator== (const Ranged_Ptr& a, const Ranged_Ptr<ANY_T> b) = delete;
 
     friend bool operator== (const Ranged_Ptr& a, const Ranged_Ptr& b) {
-        std::ostringstream error_message;
-
-        if (a.base != b.base) {
-            error_message << "Pointers used in comparison has different base    ";
-            error_message << "left pointer's base : " << (void*) a.base << " right pointer's base : " << (void*) b.base;
-            throw RangedPtrException(error_message.str());
+        if (RANGE_TYPE_UNLIKELY(a.base != b.base)) {
+            ranged_ptr_error::raise_different_base("Pointers used in comparison has different base",
+                                                   "left pointer's base", a.base, "right pointer's base", b.base);
         }
 
         return a.cur == b.cur;
@@ -214,12 +398,9 @@ public:
     friend bool operator== (const ANY_T*& b, const Ranged_Ptr& a) = delete;
 
     friend bool operator!= (const Ranged_Ptr& a, const Ranged_Ptr& b) {
-        std::ostringstream error_message;
-
-        if (a.base != b.base) {
-            error_message << "Pointers used in comparison has different base    ";
-            error_message << "left pointer's base : " << (void*) a.base << " right pointer's base : " << (void*) b.base;
-            throw RangedPtrException(error_message.str());
+        if (RANGE_TYPE_UNLIKELY(a.base != b.base)) {
+            ranged_ptr_error::raise_different_base("Pointers used in comparison has different base",
+                                                   "left pointer's base", a.base, "right pointer's base", b.base);
         }
 
         return a.cur != b.cur;
@@ -230,79 +411,421 @@ private:
     const unsigned char* const base;
     unsigned char* cur;
 
-    static void base_check(const Ranged_Ptr& a, const Ranged_Ptr& b) {
-        std::ostringstream error_message;
+    // same ranges as T_index and T_access, used to find out whether an index operation fails before Policy is applied
+    using T_index_status = Range_Type<ptr_int, 0, sizeof(T) - 1, Status_On_Violation>;
 
-        if (a.base != b.base) {
-            error_message << "Pointers have different base    ";
-            error_message << "left base : " << (void*) a.base << " right base : " << (void*) b.base;
-            throw RangedPtrException(error_message.str());
+    template <std::size_t Width>
+    using T_access_status = Range_Type<long long int, 0, sizeof(T) - Width, Status_On_Violation>;
+
+    using throws = std::is_same<Policy, Throw_On_Violation>;
+
+    static void base_check(const Ranged_Ptr& a, const Ranged_Ptr& b) {
+        if (RANGE_TYPE_UNLIKELY(a.base != b.base)) {
+            ranged_ptr_error::raise_different_base("Pointers have different base",
+                                                   "left base", a.base, "right base", b.base);
         }
     }
 
     static unsigned char* ptr_check(const Ranged_Ptr& r_ptr, const unsigned char* ptr) {
-        std::ostringstream error_message;
+        ptr_int index = index_op(r_ptr, 0, ptr - r_ptr.base, 0, (uintptr_t) ptr);
+
+        return (unsigned char*) (r_ptr.base + index);
+    }
+
+    static unsigned char* ptr_add(const Ranged_Ptr& r_ptr, const ptr_int val) {
+        ptr_int index = index_op(r_ptr, '+', r_ptr.cur - r_ptr.base, val, (uintptr_t) r_ptr.cur + val);
+
+        return (unsigned char*) (r_ptr.base + index);
+    }
+
+    static unsigned char* ptr_sub(const Ranged_Ptr& r_ptr, const ptr_int val) {
+        ptr_int index = index_op(r_ptr, '-', r_ptr.cur - r_ptr.base, val, (uintptr_t) r_ptr.cur - val);
+
+        return (unsigned char*) (r_ptr.base + index);
+    }
+
+    // start of a Width byte access at val bytes past the current position
+    template <std::size_t Width>
+    static unsigned char* ptr_access(const Ranged_Ptr& r_ptr, const ptr_int val) {
+        ptr_int index = r_ptr.cur - r_ptr.base;
 
-        T_index index;
+        return (unsigned char*) (r_ptr.base + access_op<Width>(r_ptr, index, val, throws()));
+    }
+
+    template <std::size_t Width>
+    static long long int access_op(const Ranged_Ptr& r_ptr, ptr_int index, ptr_int val, std::true_type) {
+#if CHECK_STATS
+        count_check('+', index, val, (long long int) sizeof(T) - (long long int) Width);
+#endif
+        Range_Result<T_access_status<Width>> result = T_access_status<Width>::make((long long int) index + val);
 
-        try {
-            index = ptr - r_ptr.base;
+        if (RANGE_TYPE_UNLIKELY(!result.ok())) {
+            out_of_bound(r_ptr, result.status(), '+', index, val, (uintptr_t) r_ptr.cur + val, Width);
         }
-        catch (RangeTypeException e) {
-            error_message << "Goal pointer value out of bound" << std::endl;
-            error_message << "Expressed in pointers:" << std::endl;
-            error_message << "Range : [ " << (void*) r_ptr.base << ", " << (void*) (r_ptr.base + index.last()) << " ]    ";
-            error_message << "Goal : " << (void*) ptr << std::endl;
-            error_message << "Expressed in indices:" << std::endl;
-            error_message << e.what();
-            throw RangedPtrException(error_message.str());
+
+        return result.value().value();
+    }
+
+    template <std::size_t Width>
+    static long long int access_op(const Ranged_Ptr&, ptr_int index, ptr_int val, std::false_type) {
+#if CHECK_STATS
+        count_check('+', index, val, (long long int) sizeof(T) - (long long int) Width);
+#endif
+        return T_access<Width>((long long int) index + val).value();
+    }
+
+    // a op b on the byte index, op is 0 for a plain check of a
+    // goal is the pointer value the operation aims for, only used for the error message
+    static ptr_int index_op(const Ranged_Ptr& r_ptr, char op, ptr_int a, ptr_int b, uintptr_t goal) {
+        return index_op(r_ptr, op, a, b, goal, throws());
+    }
+
+    static ptr_int index_op(const Ranged_Ptr& r_ptr, char op, ptr_int a, ptr_int b, uintptr_t goal, std::true_type) {
+#if CHECK_STATS
+        count_check(op, a, b, (long long int) sizeof(T) - 1);
+#endif
+        Range_Result<T_index_status> result = index_apply<T_index_status>(op, a, b);
+
+        if (RANGE_TYPE_UNLIKELY(!result.ok())) {
+            out_of_bound(r_ptr, result.status(), op, a, b, goal, 1);
         }
 
-        return (unsigned char*) ptr;
+        return result.value().value();
     }
 
-    static unsigned char* ptr_add(const Ranged_Ptr& r_ptr, const ptr_int val) {
-        std::ostringstream error_message;
+    static ptr_int index_op(const Ranged_Ptr&, char op, ptr_int a, ptr_int b, uintptr_t, std::false_type) {
+#if CHECK_STATS
+        count_check(op, a, b, (long long int) sizeof(T) - 1);
+#endif
+        return index_apply<T_index>(op, a, b).value();
+    }
+
+#if CHECK_STATS
+    static std::size_t stats_site() {
+        static const std::size_t site = check_stats::register_site(
+            check_stats::site_name("Ranged_Ptr", std::to_string(sizeof(T)) + " byte object", range_type_stats::policy_name<Policy>()));
+        return site;
+    }
 
-        T_index index;
+    // counted apart from the Range_Type doing the check, which is also counted under its own site
+    static void count_check(char op, long long int a, long long int b, long long int last) {
+        long long int goal = op == '+' ? a + b : op == '-' ? a - b : a;
 
-        try {
-            index = r_ptr.cur - r_ptr.base;
-            index += val;
+        check_stats::add(stats_site(), Check_Event::check);
+
+        if (RANGE_TYPE_UNLIKELY(goal < 0 || goal > last)) {
+            check_stats::add(stats_site(), Check_Event::out_of_bound);
         }
-        catch (RangeTypeException e) {
-            error_message << "Pointer addition results in out of bound pointer value" << std::endl;
-            error_message << "Expressed in pointers:" << std::endl;
-            error_message << "Range : [ " << (void*) r_ptr.base << ", " << (void*) (r_ptr.base + index.last()) << " ]    ";
-            error_message << "Goal : " << (void*) (r_ptr.cur + val) << std::endl;
-            error_message << "Expressed in indices:" << std::endl;
-            error_message << e.what();
-            throw RangedPtrException(error_message.str());
+    }
+#endif
+
+    template <typename I>
+    static typename I::result_type index_apply(char op, ptr_int a, ptr_int b) {
+        switch (op) {
+            case '+' : return I(a) + b;
+            case '-' : return I(a) - b;
+            default  : return I::make(a);
         }
+    }
 
-        return (unsigned char*) (r_ptr.base + index.value());
+    [[noreturn]] RANGE_TYPE_COLD
+    static void out_of_bound(const Ranged_Ptr& r_ptr, Range_Status status, char op, ptr_int a, ptr_int b, uintptr_t goal,
+                             std::size_t width) {
+#if CHECK_STATS
+        check_stats::Slow_Path_Timer timer(stats_site());
+#endif
+        // ranges are of the first byte accessed
+        ranged_ptr_error::raise_out_of_bound(ranged_ptr_error::reason(op, width),
+                                             r_ptr.base, r_ptr.base + sizeof(T) - width, (const void*) goal,
+                                             range_type_error::format<long long int>(0, sizeof(T) - width, status, op, a, b));
     }
+};
 
-    static unsigned char* ptr_sub(const Ranged_Ptr& r_ptr, const ptr_int val) {
-        std::ostringstream error_message;
+// Ranged pointer over a buffer whose length is only known at runtime,
+// e.g. heap memory, the contents of a std::vector<unsigned char>, or a receive buffer
+// Behaves as Ranged_Ptr with [base, base + length) in place of the object
+// Each operation is checked with a single unsigned compare against length, Policy is only consulted on failure
+// length must be non-zero, as the pointer always points at a byte within the buffer
+template <typename Policy = Throw_On_Violation>
+class Ranged_Buffer_Ptr {
+
+    static_assert(!Policy::reports_status,
+                  "Ranged_Buffer_Ptr can not report status, policy must throw, saturate, wrap or trap");
+
+public:
+    using index_type = std::ptrdiff_t;
+
+    Ranged_Buffer_Ptr() = delete;
+
+    Ranged_Buffer_Ptr(const void* in_base, std::size_t in_length) : base {(const unsigned char*) in_base}, length {non_empty(in_length)}, cur {(unsigned char*) base} {}
+
+    Ranged_Buffer_Ptr(const void* in_base, std::size_t in_length, const void* in_cur) : base {(const unsigned char*) in_base}, length {non_empty(in_length)}, cur {ptr_check(*this, in_cur)} {}
+
+    Ranged_Buffer_Ptr(const Ranged_Buffer_Ptr& r_ptr) : base {r_ptr.base}, length {r_ptr.length}, cur {r_ptr.cur} {}
+
+    Ranged_Buffer_Ptr operator= (const Ranged_Buffer_Ptr& r_ptr) {
+        base_check(*this, r_ptr, "Goal pointer has different base");
+
+        this->cur = r_ptr.cur;
+
+        return *this;
+    }
+
+    Ranged_Buffer_Ptr operator= (const void* ptr) {
+        this->cur = ptr_check(*this, ptr);
+
+        return *this;
+    }
+
+    unsigned char& operator* () const {
+        return *cur;
+    }
 
-        T_index index;
+    unsigned char& operator[] (index_type index) const {
+        return *ptr_add(*this, index);
+    }
+
+    // U read from offset bytes past the current position
+    // a single bound check covers all of [offset, offset + sizeof(U))
+    template <typename U>
+    U load (index_type offset) const {
+        static_assert(std::is_trivially_copyable<U>::value,
+                      "Type must be trivially copyable");
+
+        U result;
+        std::memcpy(&result, ptr_access(*this, offset, sizeof(U)), sizeof(U));
+        return result;
+    }
+
+    // as above, converting from order to the native byte order
+    template <typename U>
+    U load (index_type offset, Byte_Order order) const {
+        return ranged_ptr_arith::to_order(load<U>(offset), order);
+    }
+
+    template <typename U>
+    void store (index_type offset, const U& value) const {
+        static_assert(std::is_trivially_copyable<U>::value,
+                      "Type must be trivially copyable");
+
+        std::memcpy(ptr_access(*this, offset, sizeof(U)), &value, sizeof(U));
+    }
+
+    // as above, converting from the native byte order to order
+    template <typename U>
+    void store (index_type offset, const U& value, Byte_Order order) const {
+        store<U>(offset, ranged_ptr_arith::to_order(value, order));
+    }
+
+    operator unsigned char* () const {
+        return cur;
+    }
+
+    template <typename ANY_T>
+    operator ANY_T () const = delete;
+
+    unsigned char* ptr () const {
+        return this->cur;
+    }
+
+    unsigned char* first () const {
+        return (unsigned char*) this->base;
+    }
+
+    unsigned char* last () const {
+        return (unsigned char*) this->base + length - 1;
+    }
+
+    std::size_t size () const {
+        return this->length;
+    }
+
+    index_type index () const {
+        return cur - base;
+    }
+
+    friend std::ostream& operator<< (std::ostream& out, const Ranged_Buffer_Ptr& r_ptr) {
+        out << (void*) r_ptr.cur;
+        return out;
+    }
+
+    Ranged_Buffer_Ptr operator+ () const = delete;
+
+    Ranged_Buffer_Ptr operator- () const = delete;
+
+    friend Ranged_Buffer_Ptr operator+ (const Ranged_Buffer_Ptr& a, const Ranged_Buffer_Ptr& b) = delete;
+
+    friend Ranged_Buffer_Ptr operator+ (const Ranged_Buffer_Ptr& a, const index_type& b) {
+        return Ranged_Buffer_Ptr(a, ptr_add(a, b));
+    }
+
+    friend Ranged_Buffer_Ptr operator+ (const index_type& b, const Ranged_Buffer_Ptr& a) {
+        return Ranged_Buffer_Ptr(a, ptr_add(a, b));
+    }
+
+    friend Ranged_Buffer_Ptr operator- (const Ranged_Buffer_Ptr& a, const Ranged_Buffer_Ptr& b) = delete;
+
+    friend Ranged_Buffer_Ptr operator- (const Ranged_Buffer_Ptr& a, const index_type& b) {
+        return Ranged_Buffer_Ptr(a, ptr_sub(a, b));
+    }
+
+    Ranged_Buffer_Ptr operator++ () {
+        return (*this) += 1;
+    }
+
+    Ranged_Buffer_Ptr operator++ (int) {
+        Ranged_Buffer_Ptr ret(*this);
+        (*this) += 1;
+        return ret;
+    }
+
+    Ranged_Buffer_Ptr operator-- () {
+        return (*this) -= 1;
+    }
+
+    Ranged_Buffer_Ptr operator-- (int) {
+        Ranged_Buffer_Ptr ret(*this);
+        (*this) -= 1;
+        return ret;
+    }
+
+    Ranged_Buffer_Ptr operator+= (const index_type& a) {
+        this->cur = ptr_add(*this, a);
+        return *this;
+    }
+
+    Ranged_Buffer_Ptr operator-= (const index_type& a) {
+        this->cur = ptr_sub(*this, a);
+        return *this;
+    }
+
+    friend bool operator== (const Ranged_Buffer_Ptr& a, const Ranged_Buffer_Ptr& b) {
+        base_check(a, b, "Pointers used in comparison has different base");
+
+        return a.cur == b.cur;
+    }
+
+    friend bool operator!= (const Ranged_Buffer_Ptr& a, const Ranged_Buffer_Ptr& b) {
+        base_check(a, b, "Pointers used in comparison has different base");
 
-        try {
-            index = r_ptr.cur - r_ptr.base;
-            index -= val;
+        return a.cur != b.cur;
+    }
+
+private:
+    const unsigned char* const base;
+    const std::size_t length;
+    unsigned char* cur;
+
+    using throws = std::is_same<Policy, Throw_On_Violation>;
+
+    // same buffer, pointing at an index already checked
+    Ranged_Buffer_Ptr(const Ranged_Buffer_Ptr& r_ptr, unsigned char* in_cur) : base {r_ptr.base}, length {r_ptr.length}, cur {in_cur} {}
+
+    static std::size_t non_empty(std::size_t in_length) {
+        if (RANGE_TYPE_UNLIKELY(in_length == 0)) {
+            ranged_ptr_error::raise("Buffer is empty");
         }
-        catch (RangeTypeException e) {
-            error_message << "Pointer subtraction results in out of bound pointer value" << std::endl;
-            error_message << "Expressed in pointers:" << std::endl;
-            error_message << "Range : [ " << (void*) r_ptr.base << ", " << (void*) (r_ptr.base + index.last()) << " ]    ";
-            error_message << "Goal : " << (void*) (r_ptr.cur - val) << std::endl;
-            error_message << "Expressed in indices:" << std::endl;
-            error_message << e.what();
-            throw RangedPtrException(error_message.str());
+
+        return in_length;
+    }
+
+    static void base_check(const Ranged_Buffer_Ptr& a, const Ranged_Buffer_Ptr& b, const char* reason) {
+        if (RANGE_TYPE_UNLIKELY(a.base != b.base)) {
+            ranged_ptr_error::raise_different_base(reason, "left base", a.base, "right base", b.base);
         }
+    }
+
+    static unsigned char* ptr_check(const Ranged_Buffer_Ptr& r_ptr, const void* ptr) {
+        return (unsigned char*) r_ptr.base + index_op(r_ptr, 0, (const unsigned char*) ptr - r_ptr.base, 0, 1);
+    }
+
+    static unsigned char* ptr_add(const Ranged_Buffer_Ptr& r_ptr, index_type val) {
+        return (unsigned char*) r_ptr.base + index_op(r_ptr, '+', r_ptr.cur - r_ptr.base, val, 1);
+    }
+
+    static unsigned char* ptr_sub(const Ranged_Buffer_Ptr& r_ptr, index_type val) {
+        return (unsigned char*) r_ptr.base + index_op(r_ptr, '-', r_ptr.cur - r_ptr.base, val, 1);
+    }
+
+    // start of a width byte access at val bytes past the current position
+    static unsigned char* ptr_access(const Ranged_Buffer_Ptr& r_ptr, index_type val, std::size_t width) {
+        return (unsigned char*) r_ptr.base + index_op(r_ptr, '+', r_ptr.cur - r_ptr.base, val, width);
+    }
+
+    // a op b on the index of the first byte of a width byte access, op is 0 for a plain check of a
+    // a op b is formed with unsigned wrap around, so any negative result lands above length as well
+    static std::size_t index_op(const Ranged_Buffer_Ptr& r_ptr, char op, index_type a, index_type b, std::size_t width) {
+        std::size_t goal;
+
+        switch (op) {
+            case '+' : goal = std::size_t(a) + std::size_t(b); break;
+            case '-' : goal = std::size_t(a) - std::size_t(b); break;
+            default  : goal = std::size_t(a);                  break;
+        }
+
+        CHECK_STATS_ADD(stats_site(), Check_Event::check);
+
+        if (RANGE_TYPE_UNLIKELY((width > 1 && r_ptr.length < width) || goal > r_ptr.length - width)) {
+            return violation(r_ptr, op, a, b, goal, width, throws());
+        }
+
+        return goal;
+    }
+
+    static std::size_t violation(const Ranged_Buffer_Ptr& r_ptr, char op, index_type a, index_type b, std::size_t goal, std::size_t width,
+                                 std::true_type) {
+#if CHECK_STATS
+        check_stats::add(stats_site(), Check_Event::out_of_bound);
+        check_stats::Slow_Path_Timer timer(stats_site());
+#endif
+        out_of_bound(r_ptr, op, a, b, goal, width);
+    }
+
+    static std::size_t violation(const Ranged_Buffer_Ptr& r_ptr, char op, index_type a, index_type b, std::size_t, std::size_t width,
+                                 std::false_type) {
+#if CHECK_STATS
+        check_stats::add(stats_site(), Check_Event::out_of_bound);
+        check_stats::Slow_Path_Timer timer(stats_site());
+#endif
+        long long int last_index = (long long int) r_ptr.length - (long long int) width;
+
+        if (RANGE_TYPE_UNLIKELY(last_index < 0)) {     // nothing to saturate or wrap to
+            out_of_bound(r_ptr, op, a, b, std::size_t(a) + std::size_t(b), width);
+        }
+
+        return std::size_t(Policy::template on_violation<long long int>(status_of(op, a, b), op, a, b, 0, last_index));
+    }
+
+#if CHECK_STATS
+    static std::size_t stats_site() {
+        static const std::size_t site = check_stats::register_site(
+            check_stats::site_name("Ranged_Buffer_Ptr", range_type_stats::policy_name<Policy>()));
+        return site;
+    }
+#endif
+
+    // whether the result of the failing a op b lies below the buffer or above it
+    static Range_Status status_of(char op, index_type a, index_type b) {
+        bool below;
+
+        switch (op) {
+            case '+' : below = b < 0 && std::size_t(0) - std::size_t(b) > std::size_t(a); break;
+            case '-' : below = b > 0 && std::size_t(b) > std::size_t(a);                  break;
+            default  : below = a < 0;                                                      break;
+        }
+
+        return below ? Range_Status::underflow : Range_Status::overflow;
+    }
+
+    [[noreturn]] RANGE_TYPE_COLD
+    static void out_of_bound(const Ranged_Buffer_Ptr& r_ptr, char op, index_type a, index_type b, std::size_t goal, std::size_t width) {
+        long long int last_index = (long long int) r_ptr.length - (long long int) width;
 
-        return (unsigned char*) (r_ptr.base + index.value());
+        // ranges are of the first byte accessed
+        ranged_ptr_error::raise_out_of_bound(ranged_ptr_error::reason(op, width),
+                                             r_ptr.base, (const void*) ((uintptr_t) r_ptr.base + last_index),
+                                             (const void*) ((uintptr_t) r_ptr.base + goal),
+                                             range_type_error::format<long long int>(0, last_index, status_of(op, a, b), op, a, b));
     }
 };
 
@@ -0,0 +1,140 @@
+/* Mod_Batch and Mod_Array against the scalar Mod_Type operators, at the SIMD level the test is built for
+ * Lengths are not multiples of the vector width, so every kernel hands its tail to the scalar loop,
+ * and moduli cover the smallest and largest vectorised ones, a power of two, one past 2^31 and the full 2^32
+ */
+
+#include <vector>
+#include "../mod_array.h"
+#include "test.h"
+
+template <typename T, long long int UB>
+struct Values {
+    using mod_type = Mod_Type<T, UB>;
+
+    // random values in [0, UB), with 0, 1, UB - 2 and UB - 1 in front
+    static std::vector<T> make (std::size_t n, unsigned long long seed) {
+        test::Random random(seed);
+        std::vector<T> a(n);
+        const T edges[] = { T(0), T(1), T(UB - 2), T(UB - 1) };     // UB of 0 stands for 2^bits
+
+        for (std::size_t i = 0; i < n; i++) {
+            a[i] = i < 4 ? edges[i] : T(mod_type(T(random.next() >> 33)).value());
+        }
+        return a;
+    }
+
+    // as above, but invertible, so odd for a power of two and non zero for a prime
+    static std::vector<T> invertible (std::size_t n, unsigned long long seed) {
+        std::vector<T> a = make(n, seed);
+
+        for (T& x : a) {
+            if (x % 2 == 0) {
+                x = (mod_type(x) + mod_type(T(1))).value();
+            }
+            if (x == 0) {
+                x = T(1);
+            }
+        }
+        return a;
+    }
+};
+
+template <typename T, long long int UB>
+static void batch_ops () {
+    using mod_type = Mod_Type<T, UB>;
+    using batch    = Mod_Batch<T, UB>;
+
+    const std::size_t lengths[] = { 0, 1, 3, 7, 8, 9, 15, 16, 17, 31, 33, 255, 257, 1000, 4099 };
+
+    for (std::size_t n : lengths) {
+        std::vector<T> a = Values<T, UB>::make(n, 1 + n), b = Values<T, UB>::make(n, 1000 + n);
+        std::vector<T> sum_out(n), diff_out(n), prod_out(n), prod_alias(a);
+
+        batch::add(a.data(), b.data(), sum_out.data(), n);
+        batch::sub(a.data(), b.data(), diff_out.data(), n);
+        batch::mul(a.data(), b.data(), prod_out.data(), n);
+        batch::mul(prod_alias.data(), b.data(), prod_alias.data(), n);
+
+        mod_type sum, dot;
+        bool same = true;
+
+        for (std::size_t i = 0; i < n; i++) {
+            mod_type x(a[i]), y(b[i]);
+
+            same = same && sum_out[i] == (x + y).value() && diff_out[i] == (x - y).value()
+                        && prod_out[i] == (x * y).value() && prod_alias[i] == (x * y).value();
+            sum += x;
+            dot += x * y;
+        }
+
+        CHECK(same);
+        CHECK(batch::sum(a.data(), n) == sum);
+        CHECK(batch::dot(a.data(), b.data(), n) == dot);
+
+        std::vector<T> c = Values<T, UB>::invertible(n, 2000 + n), inv(n);
+        batch::inverse(c.data(), inv.data(), n);
+
+        for (std::size_t i = 0; i < n; i++) {
+            same = same && inv[i] == mod_type(c[i]).inverse().value();
+        }
+        CHECK(same);
+    }
+
+    // every value at UB - 1, the largest sums and products the kernels see
+    std::vector<T> top(4099, T(UB - 1));
+    mod_type expected;
+    for (T x : top) {
+        expected += mod_type(x);
+    }
+    CHECK(batch::sum(top.data(), top.size()) == expected);
+}
+
+template <typename T, long long int UB>
+static void array_ops () {
+    using mod_type  = Mod_Type<T, UB>;
+    using mod_array = Mod_Array<T, UB, 37>;
+
+    std::vector<T> x = Values<T, UB>::make(37, 7), y = Values<T, UB>::make(37, 8), z = Values<T, UB>::invertible(37, 9);
+    mod_array a, b, c;
+
+    for (std::size_t i = 0; i < 37; i++) {
+        a.set(i, mod_type(x[i]));
+        b.set(i, mod_type(y[i]));
+        c.set(i, mod_type(z[i]));
+    }
+
+    mod_array s = a + b, d = a - b, p = a * b, q = a, inv = c.inverse();
+    q *= b;
+    q -= a;
+    q += a;
+
+    bool same = true;
+    for (std::size_t i = 0; i < 37; i++) {
+        same = same && s[i] == a[i] + b[i] && d[i] == a[i] - b[i] && p[i] == a[i] * b[i] && q[i] == p[i]
+                    && inv[i] == c[i].inverse();
+    }
+
+    CHECK(same);
+    CHECK(q == p && !(q != p));
+}
+
+template <typename T, long long int UB>
+static void both () {
+    batch_ops<T, UB>();
+    array_ops<T, UB>();
+}
+
+int main () {
+    both<unsigned int, 3>();
+    both<unsigned int, 998244353>();
+    both<unsigned int, 2147483647>();
+    both<unsigned int, 2147483648LL>();
+    both<unsigned int, 4294967291LL>();
+    both<unsigned int, 0>();
+    both<int, 3>();
+    both<int, 2147483647>();
+    both<int, 2147483648LL>();
+
+    std::printf("simd level %d, ", int(mod_simd_level()));
+    return test::report("mod_array_test");
+}
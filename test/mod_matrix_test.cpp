@@ -0,0 +1,95 @@
+/* Mod_Matrix against schoolbook multiplication over Mod_Type
+ * The shared dimension runs past both the lazy limit of every accumulator kind and depth_block,
+ * so products are reduced part way as well as at the end, and shapes are not multiples of the tile sizes
+ */
+
+#include <vector>
+#include "../mod_matrix.h"
+#include "test.h"
+
+template <typename T, long long int UB>
+static Mod_Matrix<T, UB> random_matrix (std::size_t rows, std::size_t cols, unsigned long long seed, bool top = false) {
+    using mod_type = Mod_Type<T, UB>;
+
+    test::Random random(seed);
+    Mod_Matrix<T, UB> a(rows, cols);
+
+    for (std::size_t i = 0; i < rows; i++) {
+        for (std::size_t j = 0; j < cols; j++) {
+            a.set(i, j, top ? mod_type(T(UB - 1)) : mod_type(T(random.next() >> 1)));      // UB of 0 stands for 2^bits
+        }
+    }
+    return a;
+}
+
+template <typename T, long long int UB>
+static Mod_Matrix<T, UB> schoolbook (const Mod_Matrix<T, UB>& a, const Mod_Matrix<T, UB>& b) {
+    Mod_Matrix<T, UB> c(a.rows(), b.cols());
+
+    for (std::size_t i = 0; i < a.rows(); i++) {
+        for (std::size_t j = 0; j < b.cols(); j++) {
+            Mod_Type<T, UB> sum;
+            for (std::size_t p = 0; p < a.cols(); p++) {
+                sum += a(i, p) * b(p, j);
+            }
+            c.set(i, j, sum);
+        }
+    }
+    return c;
+}
+
+template <typename T, long long int UB>
+static void products () {
+    using matrix   = Mod_Matrix<T, UB>;
+    using lazy_sum = mod_matrix_arith::Lazy_Sum<T, UB>;
+
+    // only 3 and powers of two give accumulators that never need reducing part way
+    CHECK(lazy_sum::lazy < 300 || UB == 3 || (UB & (UB - 1)) == 0);
+
+    // rows x shared x cols, 300 being above lazy and depth_block
+    const std::size_t shapes[][3] = { {1, 1, 1}, {3, 5, 2}, {16, 7, 128}, {17, 300, 129}, {33, 513, 5} };
+
+    for (const auto& s : shapes) {
+        matrix a = random_matrix<T, UB>(s[0], s[1], s[0] + s[1]), b = random_matrix<T, UB>(s[1], s[2], s[1] + s[2]);
+        matrix expected = schoolbook(a, b);
+
+        CHECK(a * b == expected);
+        CHECK(matrix::multiply(a, b, 3) == expected);
+
+        // every product at (UB - 1)^2, the most an accumulator can be given
+        matrix x = random_matrix<T, UB>(s[0], s[1], 0, true), y = random_matrix<T, UB>(s[1], s[2], 0, true);
+        CHECK(x * y == schoolbook(x, y));
+    }
+
+    matrix a = random_matrix<T, UB>(9, 9, 1), b = random_matrix<T, UB>(9, 9, 2), c = random_matrix<T, UB>(9, 4, 3);
+    matrix sum = a + b, diff = a - b;
+    bool same = true;
+    for (std::size_t i = 0; i < 9; i++) {
+        for (std::size_t j = 0; j < 9; j++) {
+            same = same && sum(i, j) == a(i, j) + b(i, j) && diff(i, j) == a(i, j) - b(i, j);
+        }
+    }
+    CHECK(same);
+
+    CHECK(a.pow(0) == matrix::identity(9));
+    CHECK(a.pow(5) == schoolbook(schoolbook(schoolbook(schoolbook(a, a), a), a), a));
+
+    CHECK_THROWS(ModTypeException, c * a);
+    CHECK_THROWS(ModTypeException, a + c);
+    CHECK_THROWS(ModTypeException, c.pow(2));
+}
+
+int main () {
+    products<unsigned int, 3>();
+    products<unsigned int, 998244353>();
+    products<unsigned int, 2147483647>();
+    products<unsigned int, 2147483648LL>();
+    products<unsigned int, 4294967291LL>();
+    products<unsigned int, 0>();
+    products<unsigned long long, 4179340454199820289LL>();
+    products<unsigned long long, 0>();
+    products<int, 2147483647>();
+
+    std::printf("simd level %d, ", int(mod_simd_level()));
+    return test::report("mod_matrix_test");
+}
@@ -0,0 +1,104 @@
+/* Mod_Ntt against a textbook transform and schoolbook convolution over Mod_Type
+ * Sizes run over both odd and even log2(n), so the leftover radix-2 pass is covered along with the radix-4 ones,
+ * and convolutions take both the direct path and the transform path
+ */
+
+#include <vector>
+#include "../mod_ntt.h"
+#include "test.h"
+
+template <typename T, long long int UB>
+static std::vector<Mod_Type<T, UB>> random_values (std::size_t n, unsigned long long seed) {
+    test::Random random(seed);
+    std::vector<Mod_Type<T, UB>> a(n);
+    const T edges[] = { T(0), T(1), T(UB - 1) };
+
+    for (std::size_t i = 0; i < n; i++) {
+        a[i] = Mod_Type<T, UB>(i < 3 ? edges[i] : T(random.next() % (unsigned long long) UB));
+    }
+    return a;
+}
+
+template <typename T, long long int UB>
+static void transforms (std::size_t max_size) {
+    using mod_type = Mod_Type<T, UB>;
+
+    Mod_Ntt<T, UB> ntt(max_size);
+
+    for (std::size_t n = 1; n <= max_size; n *= 2) {
+        // the transform of x^1 is w^k, giving the root of unity the engine uses
+        std::vector<mod_type> unit(n);
+        unit[n > 1 ? 1 : 0] = mod_type(T(1));
+        ntt.transform(unit);
+        mod_type w = unit[n > 1 ? 1 : 0];
+
+        CHECK(w.pow(n) == mod_type(T(1)));
+        CHECK(n == 1 || w.pow(n / 2) != mod_type(T(1)));
+
+        std::vector<mod_type> a = random_values<T, UB>(n, n), f(a);
+        ntt.transform(f);
+
+        bool same = true;
+        for (std::size_t k = 0; k < n; k++) {
+            mod_type sum, wk = w.pow(k), x(T(1));
+
+            for (std::size_t i = 0; i < n; i++) {
+                sum += a[i] * x;
+                x *= wk;
+            }
+            same = same && f[k] == sum;
+        }
+        CHECK(same);
+
+        ntt.inverse_transform(f);
+        CHECK(f == a);
+    }
+
+    std::vector<mod_type> too_long(max_size * 2), not_power(max_size > 2 ? 3 : 0);
+    CHECK_THROWS(ModTypeException, ntt.transform(too_long));
+    CHECK_THROWS(ModTypeException, ntt.inverse_transform(not_power));
+}
+
+template <typename T, long long int UB>
+static void convolutions (std::size_t max_size) {
+    using mod_type = Mod_Type<T, UB>;
+
+    Mod_Ntt<T, UB> ntt(max_size);
+
+    // direct below 32 values on a side, transforms of 128, 256 and 512 values above
+    const std::size_t lengths[][2] = { {0, 5}, {1, 1}, {5, 40}, {32, 32}, {33, 33}, {33, 100}, {100, 31}, {200, 300} };
+
+    for (const auto& len : lengths) {
+        std::vector<mod_type> a = random_values<T, UB>(len[0], 3 * len[0]), b = random_values<T, UB>(len[1], 5 * len[1]);
+        std::vector<mod_type> expected(a.empty() || b.empty() ? 0 : a.size() + b.size() - 1);
+
+        for (std::size_t i = 0; i < a.size(); i++) {
+            for (std::size_t j = 0; j < b.size(); j++) {
+                expected[i + j] += a[i] * b[j];
+            }
+        }
+
+        CHECK(ntt.convolve(a, b) == expected);
+    }
+
+    std::vector<mod_type> a(max_size / 2 + 1), b(max_size / 2 + 1);
+    CHECK_THROWS(ModTypeException, ntt.convolve(a, b));
+}
+
+int main () {
+    transforms<unsigned int, 998244353>(1024);
+    transforms<unsigned int, 7340033>(512);
+    transforms<int, 998244353>(64);
+    transforms<unsigned long long, 4179340454199820289LL>(256);
+    transforms<unsigned int, 3>(2);
+    transforms<unsigned int, 4294967291LL>(2);
+
+    convolutions<unsigned int, 998244353>(512);
+    convolutions<unsigned long long, 4179340454199820289LL>(512);
+
+    CHECK_THROWS(ModTypeException, Mod_Ntt<unsigned int, 998244353>(3));
+    CHECK_THROWS(ModTypeException, Mod_Ntt<unsigned int, 998244353>(std::size_t(1) << 24));
+    CHECK_THROWS(ModTypeException, Mod_Ntt<unsigned int, 4294967291LL>(4));
+
+    return test::report("mod_ntt_test");
+}
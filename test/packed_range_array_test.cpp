@@ -0,0 +1,155 @@
+/* Packed_Range_Array against a plain vector of the same values, at the SIMD level the test is built for
+ * Widths run from 0 to 64 bits, across the 25 bits the decode kernels take and the 57 bits read in one load,
+ * decodes start and end off the 8 and 64 value groups, and writes of single values must leave their neighbours alone
+ */
+
+#include <climits>
+#include <vector>
+#include "../packed_range_array.h"
+#include "test.h"
+
+template <typename T, long long int F, long long int L>
+static std::vector<T> random_values (std::size_t n, unsigned long long seed) {
+    test::Random random(seed);
+    std::vector<T> a(n);
+    const unsigned long long range = (unsigned long long) L - (unsigned long long) F;
+
+    for (std::size_t i = 0; i < n; i++) {
+        unsigned long long x = random.next();
+        a[i] = T((unsigned long long) F + (range == ULLONG_MAX ? x : i % 5 == 0 ? range : i % 5 == 1 ? 0 : x % (range + 1)));
+    }
+    return a;
+}
+
+template <typename T, long long int F, long long int L>
+static void decodes () {
+    using array = Packed_Range_Array<T, F, L>;
+
+    const std::size_t lengths[] = { 0, 1, 7, 8, 9, 63, 64, 65, 129, 1000, 4097, 9000 };
+
+    for (std::size_t n : lengths) {
+        std::vector<T> a = random_values<T, F, L>(n, n + 1);
+        array p;
+        CHECK(p.assign(a) == array::npos);
+        CHECK(p.size() == n && p.decode() == a);
+
+        bool same = true;
+        for (std::size_t i = 0; i < n; i++) {
+            same = same && p[i].value() == a[i];
+        }
+        CHECK(same);
+
+        // every start within a group of 64, with lengths reaching past the vector widths and the groups
+        for (std::size_t first = 0; first < 66 && first < n; first++) {
+            for (std::size_t len : { std::size_t(1), std::size_t(15), std::size_t(17), std::size_t(130), n - first }) {
+                len = std::min(len, n - first);
+                std::vector<T> out(len);
+                p.decode(first, len, out.data());
+                same = same && std::equal(out.begin(), out.end(), a.begin() + first);
+            }
+        }
+        CHECK(same);
+
+        CHECK(array::deserialize(p.serialize()) == p);
+    }
+}
+
+template <typename T, long long int F, long long int L>
+static void writes () {
+    using array      = Packed_Range_Array<T, F, L>;
+    using value_type = typename array::value_type;
+
+    // set one value in an array of the other end, then check every value, for each position in two words
+    for (std::size_t i = 0; i < 130; i++) {
+        std::vector<T> a(131, T(L));
+        array p;
+        p.assign(a);
+
+        a[i] = T(F);
+        p.set(i, value_type(T(F)));
+        CHECK(p.decode() == a);
+
+        a[i] = T(L);
+        p.set(i, value_type(T(L)));
+        CHECK(p.decode() == a);
+    }
+
+    // random writes over random values, and pushes of both kinds
+    std::vector<T> a = random_values<T, F, L>(300, 1), b = random_values<T, F, L>(2000, 2);
+    array p;
+    p.assign(a);
+
+    for (std::size_t k = 0; k < b.size(); k++) {
+        std::size_t i = std::size_t(b[k]) % a.size();
+        a[i] = b[k];
+        p.set(i, value_type(b[k]));
+    }
+    for (std::size_t k = 0; k < 200; k++) {
+        a.push_back(b[k]);
+        if (k % 2 == 0) {
+            p.push_back(value_type(b[k]));
+        } else {
+            CHECK(p.push_back(b[k]) == array::npos);
+        }
+    }
+    CHECK(p.decode() == a);
+}
+
+// a value outside the range in the second block of 4096, after the first has been packed
+template <typename T, long long int F, long long int L>
+static void failures () {
+    std::vector<T> a = random_values<T, F, L>(100, 3), b = random_values<T, F, L>(5000, 4);
+    b[4500] = T(L + 1);
+
+    Packed_Range_Array<T, F, L> thrown;
+    thrown.assign(a);
+    Packed_Range_Array<T, F, L> before = thrown;
+    try {
+        thrown.append(b);
+        CHECK(false);
+    } catch (const RangeVectorException& e) {
+        CHECK(e.index() == 4500);
+    }
+    CHECK(thrown == before);
+
+    Packed_Range_Array<T, F, L, Status_On_Violation> reported;
+    reported.assign(a);
+    CHECK(reported.append(b) == 4500);
+    CHECK(reported.decode() == a);
+    CHECK(reported.assign(b) == 4500 && reported.empty());
+
+    Packed_Range_Array<T, F, L, Saturate_On_Violation> saturated;
+    saturated.assign(a);
+    CHECK(saturated.append(b) == 4500);
+    std::vector<T> expected = a;
+    expected.insert(expected.end(), b.begin(), b.end());
+    expected[a.size() + 4500] = T(L);
+    CHECK(saturated.decode() == expected);
+}
+
+template <typename T, long long int F, long long int L>
+static void all () {
+    decodes<T, F, L>();
+    writes<T, F, L>();
+}
+
+int main () {
+    all<int, 7, 7>();
+    all<int, 0, 1>();
+    all<int, -5, 10>();
+    all<int, -1000, 1000>();
+    all<unsigned int, 0, (1 << 25) - 1>();
+    all<int, -(1 << 24), 1 << 24>();
+    all<int, INT_MIN, INT_MAX>();
+    all<unsigned short, 0, 1000>();
+    all<long long, 0, (1LL << 57) - 1>();
+    all<long long, 0, (1LL << 58) - 1>();
+    all<long long, LLONG_MIN, LLONG_MAX>();
+
+    failures<int, -5, 10>();
+    failures<unsigned int, 0, (1 << 25) - 2>();
+    failures<long long, -1, (1LL << 60)>();
+
+    std::printf("simd level %d, ", packed_range::simd_level());
+    return test::report("packed_range_array_test");
+}
@@ -0,0 +1,77 @@
+/* Range_Interval bounds and results, mostly at the limits of 64 bit types where bound arithmetic saturates
+ */
+
+#include <climits>
+#include "../range_interval.h"
+#include "test.h"
+
+using ll  = long long int;
+using ull = unsigned long long int;
+
+static void small_types () {
+    Range_Type<int, 0, 100> a(60), b(70);
+
+    auto s = interval(a) + b;
+    CHECK(s.first() == 0 && s.last() == 200 && s.value() == 130);
+
+    auto d = b - interval(a);
+    CHECK(d.first() == -100 && d.last() == 100 && d.value() == 10);
+
+    auto p = interval(a) * interval(b);
+    CHECK(p.first() == 0 && p.last() == 10000 && p.value() == 4200);
+
+    CHECK_THROWS(RangeTypeException, Range_Type<int, 0, 100>(s));
+
+    Range_Type<int, INT_MAX - 1, INT_MAX> m(INT_MAX);
+    CHECK_THROWS(RangeTypeException, interval(m) + m);
+}
+
+// a bound past LLONG_MAX saturates to exactly the limit of long long, the operation must still be checked
+static void long_long () {
+    No_Wrap<ll> max(LLONG_MAX), min(LLONG_MIN), one(1), minus_one(-1);
+
+    CHECK_THROWS(RangeTypeException, interval(max) + max);
+    CHECK_THROWS(RangeTypeException, interval(max) + one);
+    CHECK_THROWS(RangeTypeException, interval(min) - one);
+    CHECK_THROWS(RangeTypeException, interval(min) + minus_one);
+    CHECK_THROWS(RangeTypeException, interval(max) * max);
+    CHECK_THROWS(RangeTypeException, interval(min) * minus_one);
+    CHECK_THROWS(RangeTypeException, interval(max) - minus_one);
+
+    // saturated bounds, results that fit
+    CHECK((interval(max) + minus_one).value() == LLONG_MAX - 1);
+    CHECK((interval(min) + max).value() == -1);
+    CHECK((interval(one) * max).value() == LLONG_MAX);
+    CHECK((interval(minus_one) * max).value() == -LLONG_MAX);
+
+    Range_Type<ll, 0, LLONG_MAX / 2> h(LLONG_MAX / 2);
+    auto s = interval(h) + h;
+    CHECK(s.last() == LLONG_MAX - 1 && s.value() == LLONG_MAX - 1);
+}
+
+// unsigned long long bounds are capped at LLONG_MAX, though the type holds twice that
+static void unsigned_long_long () {
+    Range_Type<ull, 0, LLONG_MAX> max((ull) LLONG_MAX), zero(0);
+
+    CHECK_THROWS(RangeTypeException, interval(max) + max);
+    CHECK_THROWS(RangeTypeException, interval(max) * max);
+    CHECK_THROWS(RangeTypeException, interval(zero) - max);
+
+    CHECK((interval(max) + zero).value() == (ull) LLONG_MAX);
+    CHECK((interval(max) - max).value() == 0);
+
+    Range_Type<ull, 0, LLONG_MAX> back = interval(max) + zero;
+    CHECK(back.value() == (ull) LLONG_MAX);
+}
+
+#if __cplusplus >= 201402L
+static_assert((interval(Range_Type<ll, 0, 10>(7)) * Range_Type<ll, -3, 3>(-3)).value() == -21, "");
+#endif
+
+int main () {
+    small_types();
+    long_long();
+    unsigned_long_long();
+
+    return test::report("range_interval_test");
+}
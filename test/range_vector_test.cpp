@@ -0,0 +1,78 @@
+/* Range_Vector bulk checks against a value by value check, with values just inside and just outside [F, L]
+ * placed at every position of a block, including ranges at the ends of the underlying type
+ */
+
+#include <algorithm>
+#include <climits>
+#include <limits>
+#include <vector>
+#include "../range_vector.h"
+#include "test.h"
+
+template <typename T, long long int F, long long int L>
+static void bounds () {
+    using vector = Range_Vector<T, F, L>;
+
+    const std::size_t lengths[] = { 1, 63, 64, 65, 4096, 4097, 9000 };
+
+    std::vector<long long int> outside;
+    if (F > (long long int) std::numeric_limits<T>::min()) {
+        outside.push_back(F - 1);
+    }
+    if (L < (long long int) std::numeric_limits<T>::max()) {
+        outside.push_back(L + 1);
+    }
+    if (F > (long long int) std::numeric_limits<T>::min() + 1000) {
+        outside.push_back((long long int) std::numeric_limits<T>::min());
+    }
+    if (L < (long long int) std::numeric_limits<T>::max() - 1000) {
+        outside.push_back((long long int) std::numeric_limits<T>::max());
+    }
+
+    for (std::size_t n : lengths) {
+        std::vector<T> a(n);
+        for (std::size_t i = 0; i < n; i++) {
+            a[i] = T(i % 2 == 0 ? F : L);
+        }
+        CHECK(vector::find_invalid(a.data(), n) == vector::npos);
+
+        vector v;
+        CHECK(v.assign(a) == vector::npos && std::equal(v.begin(), v.end(), a.begin()));
+
+        bool found = true;
+        for (long long int x : outside) {
+            for (std::size_t i = 0; i < n; i += n / 7 + 1) {
+                std::vector<T> b = a;
+                b[i] = T(x);
+                b[n - 1] = T(x);
+                found = found && vector::find_invalid(b.data(), n) == i;
+            }
+        }
+        CHECK(found);
+    }
+
+    // the values appended come from the vector itself, and are read before it reallocates
+    vector v;
+    std::vector<T> a(100, T(L));
+    v.assign(a);
+    v.append(v.data(), v.size());
+    v.append(v.data() + 50, 150);
+    CHECK(v.size() == 350);
+    CHECK(v.assign(v.data() + 10, 20) == vector::npos && v.size() == 20 && v[19].value() == T(L));
+}
+
+int main () {
+    bounds<signed char, -100, 100>();
+    bounds<signed char, SCHAR_MIN, 0>();
+    bounds<unsigned char, 1, 254>();
+    bounds<short, -1, 1>();
+    bounds<int, -1000000, 1000000>();
+    bounds<int, INT_MIN, INT_MAX - 1>();
+    bounds<unsigned int, 0, 1000>();
+    bounds<unsigned int, 1000, UINT_MAX>();
+    bounds<long long, LLONG_MIN, LLONG_MAX>();
+    bounds<long long, LLONG_MIN + 1, -1>();
+    bounds<unsigned long long, 5, LLONG_MAX>();
+
+    return test::report("range_vector_test");
+}
@@ -0,0 +1,49 @@
+/* Minimal checking for the tests in this directory
+ * CHECK records a failure with its line and carries on, CHECK_THROWS(E, expression) does the same unless the expression throws E
+ * Each test returns report(name) from main, which is non-zero if any check failed
+ */
+
+#include <cstdio>
+
+#ifndef TEST_H_INCLUDED
+#define TEST_H_INCLUDED
+
+namespace test {
+    inline int& failures () {
+        static int count = 0;
+        return count;
+    }
+
+    inline void fail (const char* file, int line, const char* text) {
+        std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, text);
+        failures()++;
+    }
+
+    // fixed seed generator, so a failure repeats on every run
+    class Random {
+    public:
+        explicit Random (unsigned long long seed) : x {seed} {}
+
+        unsigned long long next () {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            return x;
+        }
+
+    private:
+        unsigned long long x;
+    };
+
+    inline int report (const char* name) {
+        std::printf("%s: %s\n", name, failures() == 0 ? "ok" : "FAILED");
+        return failures() == 0 ? 0 : 1;
+    }
+}
+
+#define CHECK(x) do { if (!(x)) { test::fail(__FILE__, __LINE__, #x); } } while (0)
+
+#define CHECK_THROWS(E, ...) do { bool thrown = false; try { (void) (__VA_ARGS__); } catch (const E&) { thrown = true; } \
+                                if (!thrown) { test::fail(__FILE__, __LINE__, #__VA_ARGS__ " throws " #E); } } while (0)
+
+#endif // TEST_H_INCLUDED